@@ -9,12 +9,55 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    antcolony.cpp \
+    branchandbound.cpp \
+    christofides.cpp \
+    cityfileparser.cpp \
+    citydatabase.cpp \
+    citylayeritem.cpp \
+    citylistmodel.cpp \
     citymanager.cpp \
+    citypool.cpp \
+    geneticalgorithm.cpp \
+    linkernighan.cpp \
+    localsearch.cpp \
+    pointpyramid.cpp \
+    solverservice.cpp \
+    spatialgrid.cpp \
+    threadpool.cpp \
+    tourconstruction.cpp \
+    tourlayeritem.cpp \
+    twoleveltour.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
+    antcolony.h \
+    arraytour.h \
+    branchandbound.h \
+    christofides.h \
+    cityfileparser.h \
+    citydatabase.h \
+    citylayeritem.h \
+    citylistmodel.h \
     citymanager.h \
+    citypool.h \
+    disjointset.h \
+    distancematrix.h \
+    geneticalgorithm.h \
+    linkernighan.h \
+    localsearch.h \
+    pointpyramid.h \
+    solvercontrol.h \
+    solverservice.h \
+    spatialgrid.h \
+    stepsink.h \
+    threadpool.h \
+    tourbuffer.h \
+    tourconstruction.h \
+    tourlayeritem.h \
+    twoleveltour.h \
+    xoshiro256.h \
     mainwindow.h
 
 FORMS += \
@@ -0,0 +1,211 @@
+#include "antcolony.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double MIN_DISTANCE = 1e-9;   // 重合城市的距离按此计算, 避免启发值无穷大
+const double BEST_PROBABILITY = 0.05; // 收敛时蚂蚁恰好走出最优回路的概率, 用于确定 tauMin
+const int STAGNATION_LIMIT = 150;   // 连续这么多轮没有改进就重置信息素
+
+// 隔多少轮改由历史最优蚂蚁留信息素: 开始时以本轮最优为主保持多样性, 之后逐渐集中到历史最优
+int globalBestInterval(int iteration) {
+    if (iteration < 25) return 25;
+    if (iteration < 75) return 5;
+    if (iteration < 125) return 3;
+    if (iteration < 250) return 2;
+    return 1;
+}
+
+} // namespace
+
+AntColony::AntColony(const CityCoordinates &coords, int candidateCount, int threadCount)
+    : coords(coords), n(coords.size()), candidates(coords, candidateCount),
+      k(candidates.neighborCount()), pool(threadCount) {
+    heuristic.resize(static_cast<size_t>(n) * k);
+    for (int i = 0; i < n; ++i) {
+        const int *neighbor = candidates.neighbors(i);
+        for (int c = 0; c < k; ++c) {
+            double d = qMax(dist(i, neighbor[c]), MIN_DISTANCE);
+            heuristic[static_cast<size_t>(i) * k + c] = 1.0 / (d * d);
+        }
+    }
+    pheromone.resize(heuristic.size());
+    choiceInfo.resize(heuristic.size());
+
+    entries.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        entries.append({coords.x[i], coords.y[i], i});
+    }
+    workspaces.reserve(pool.threadCount());
+    for (int w = 0; w < pool.threadCount(); ++w) {
+        workspaces.push_back({candidates, std::vector<char>(n), std::vector<double>(k), SpatialGrid()});
+    }
+}
+
+void AntColony::setCancelFlag(const std::atomic<bool> *flag) {
+    cancelFlag = flag;
+    for (Workspace &workspace : workspaces) workspace.search.setCancelFlag(flag);
+}
+
+void AntColony::constructTour(Ant &ant, Workspace &workspace) const {
+    std::vector<char> &visited = workspace.visited;
+    std::fill(visited.begin(), visited.end(), 0);
+    workspace.unvisited.build(entries);
+    double *weight = workspace.weight.data();
+
+    ant.tour.resize(n);
+    int current = ant.gen.uniform(n);
+    ant.tour[0] = current;
+    visited[current] = 1;
+    workspace.unvisited.remove(current, coords.x[current], coords.y[current]);
+
+    for (int step = 1; step < n; ++step) {
+        const int *neighbor = candidates.neighbors(current);
+        const double *info = &choiceInfo[static_cast<size_t>(current) * k];
+
+        // 已访问城市的权重乘 0, 循环中没有分支
+        double total = 0;
+        for (int c = 0; c < k; ++c) {
+            weight[c] = info[c] * (visited[neighbor[c]] ^ 1);
+            total += weight[c];
+        }
+
+        int next = -1;
+        if (total > 0) {
+            double r = ant.gen.uniformReal() * total;
+            int c = 0;
+            while (c < k - 1 && (r -= weight[c]) >= 0) c++;
+            // 舍入可能落到权重为 0 的尾部, 退回到最后一个可选的候选
+            while (weight[c] == 0) c--;
+            next = neighbor[c];
+        } else {
+            next = workspace.unvisited.nearest(coords.x[current], coords.y[current], 1).first();
+        }
+
+        ant.tour[step] = next;
+        visited[next] = 1;
+        workspace.unvisited.remove(next, coords.x[next], coords.y[next]);
+        current = next;
+    }
+
+    ant.length = localSearchEnabled ? workspace.search.optimize(ant.tour) : candidates.tourLength(ant.tour);
+}
+
+void AntColony::deposit(int from, int to, double amount) {
+    const int *neighbor = candidates.neighbors(from);
+    for (int c = 0; c < k; ++c) {
+        if (neighbor[c] == to) {
+            pheromone[static_cast<size_t>(from) * k + c] += amount;
+            return;
+        }
+    }
+}
+
+void AntColony::updatePheromone(const std::vector<int> &tour, double amount, double low, double high) {
+    const double keep = 1 - rho;
+    for (double &tau : pheromone) tau *= keep;
+    for (int i = 0; i < n; ++i) {
+        int a = tour[i];
+        int b = tour[i + 1 == n ? 0 : i + 1];
+        deposit(a, b, amount);
+        deposit(b, a, amount);
+    }
+    for (double &tau : pheromone) tau = qBound(low, tau, high);
+}
+
+std::vector<int> AntColony::solve() {
+    QElapsedTimer timer;
+    timer.start();
+    progress = Progress();
+
+    std::vector<int> best(n);
+    for (int i = 0; i < n; ++i) best[i] = i;
+    if (n <= 3) {
+        progress.bestLength = candidates.tourLength(best);
+        return best;
+    }
+
+    // 蚂蚁的随机数流按编号分配, 与执行它的线程无关
+    int count = ants();
+    std::vector<Ant> colony(count);
+    Xoshiro256 stream(seed);
+    for (Ant &ant : colony) {
+        stream.jump();
+        ant.gen = stream;
+    }
+
+    // 初始信息素按最近邻回路估计的 tauMax
+    best = candidates.nearestNeighborTour();
+    double bestLength = candidates.tourLength(best);
+    double tauMax = 1 / (rho * bestLength);
+    double pRoot = std::pow(BEST_PROBABILITY, 1.0 / n);
+    double averageChoices = qMax(2.0, k / 2.0);
+    auto minimumFor = [&](double high) {
+        return qMin(high, high * (1 - pRoot) / ((averageChoices - 1) * pRoot));
+    };
+    double tauMin = minimumFor(tauMax);
+    std::fill(pheromone.begin(), pheromone.end(), tauMax);
+
+    int lastImprovement = 0;
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        if (timeLimitMs > 0 && timer.elapsed() >= timeLimitMs) break;
+        if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) break;
+
+        // 选择概率的分子, 连续数组上的逐元素乘法
+        const double *tau = pheromone.data();
+        const double *eta = heuristic.data();
+        double *info = choiceInfo.data();
+        for (size_t e = 0, size = choiceInfo.size(); e < size; ++e) info[e] = tau[e] * eta[e];
+
+        pool.run(count, [&](int a, int worker) {
+            constructTour(colony[a], workspaces[worker]);
+        });
+
+        // 按蚂蚁编号顺序汇总
+        int iterationBest = 0;
+        double sum = 0;
+        for (int a = 0; a < count; ++a) {
+            sum += colony[a].length;
+            if (colony[a].length < colony[iterationBest].length) iterationBest = a;
+        }
+        bool improved = colony[iterationBest].length < bestLength - 1e-10;
+        if (improved) {
+            best = colony[iterationBest].tour;
+            bestLength = colony[iterationBest].length;
+            lastImprovement = iteration;
+            tauMax = 1 / (rho * bestLength);
+            tauMin = minimumFor(tauMax);
+        }
+
+        if (iteration - lastImprovement >= STAGNATION_LIMIT) {
+            std::fill(pheromone.begin(), pheromone.end(), tauMax);
+            lastImprovement = iteration;
+            progress.restarts++;
+        } else {
+            bool useGlobal = (iteration + 1) % globalBestInterval(iteration) == 0;
+            const std::vector<int> &tour = useGlobal ? best : colony[iterationBest].tour;
+            double length = useGlobal ? bestLength : colony[iterationBest].length;
+            updatePheromone(tour, 1 / length, tauMin, tauMax);
+        }
+
+        progress.iteration = iteration + 1;
+        progress.bestLength = bestLength;
+        progress.iterationBest = colony[iterationBest].length;
+        progress.iterationMean = sum / count;
+        progress.tauMax = tauMax;
+        progress.tauMin = tauMin;
+        progress.elapsedMs = timer.elapsed();
+        progress.improved = improved;
+        if (callback) {
+            progress.tour = &best;
+            callback(progress);
+            progress.tour = nullptr;
+        }
+    }
+
+    progress.bestLength = bestLength;
+    progress.elapsedMs = timer.elapsed();
+    return best;
+}
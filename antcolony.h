@@ -0,0 +1,115 @@
+#ifndef ANTCOLONY_H
+#define ANTCOLONY_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "distancematrix.h"
+#include "localsearch.h"
+#include "spatialgrid.h"
+#include "threadpool.h"
+#include "xoshiro256.h"
+
+// MAX-MIN 蚁群算法(MMAS)
+// 信息素只保存在每个城市的 k 条候选边上(n*k 而不是 n*n), 蚂蚁按 信息素 * (1/距离)² 的比例在未访问的候选城市中选下一个,
+// 候选城市都已访问时走到最近的未访问城市; 每轮所有蚂蚁在线程池上并行构造回路并用 2-opt/Or-opt 改进,
+// 之后全部信息素挥发, 只有本轮最优或历史最优的蚂蚁留下信息素, 信息素始终限制在 [tauMin, tauMax] 内,
+// 长时间没有改进时把信息素重置为 tauMax 重新开始.
+// 每只蚂蚁有自己的随机数流(由种子 jump() 分出), 种子、蚂蚁数和轮数相同时结果可重现, 与线程数无关
+class AntColony {
+public:
+    // 进度信息
+    struct Progress {
+        int iteration = 0;          // 已完成的轮数
+        double bestLength = 0;      // 历史最优回路长度
+        double iterationBest = 0;   // 本轮最优回路长度
+        double iterationMean = 0;   // 本轮平均回路长度
+        double tauMax = 0;          // 信息素上限
+        double tauMin = 0;          // 信息素下限
+        int restarts = 0;           // 信息素重置次数
+        qint64 elapsedMs = 0;       // 已用时间
+        bool improved = false;      // 本轮是否找到更优解
+        const std::vector<int> *tour = nullptr; // 历史最优回路, 只在回调期间有效
+    };
+
+    // 坐标需在对象使用期间保持有效; threadCount <= 0 时使用 CPU 核心数
+    explicit AntColony(const CityCoordinates &coords, int candidateCount = 12, int threadCount = 0);
+
+    // 每轮的蚂蚁数, 默认 25(不超过城市数)
+    void setAntCount(int count) { antCount = qMax(1, count); }
+
+    // 最大轮数和时间上限(毫秒), 先到为准; 时间上限为 0 表示不限
+    void setIterations(int count) { maxIterations = qMax(1, count); }
+    void setTimeLimit(qint64 ms) { timeLimitMs = ms; }
+
+    // 信息素挥发率
+    void setEvaporation(double rate) { rho = qBound(0.001, rate, 1.0); }
+
+    // 蚂蚁构造回路后是否做局部搜索, 默认是
+    void setLocalSearchEnabled(bool enabled) { localSearchEnabled = enabled; }
+
+    void setSeed(quint64 value) { seed = value; }
+
+    // 取消标志, 置位后在本轮结束时停止, 返回历史最优回路
+    void setCancelFlag(const std::atomic<bool> *flag);
+
+    // 进度回调, 每轮结束时调用一次
+    void setProgressCallback(std::function<void(const Progress &)> func) { callback = func; }
+
+    // 返回历史最优回路(城市编号序列)
+    std::vector<int> solve();
+
+    const Progress &lastProgress() const { return progress; }
+    int threadCount() const { return pool.threadCount(); }
+    int ants() const { return qMin(antCount, n); }
+
+private:
+    struct Ant {
+        std::vector<int> tour;
+        double length = 0;
+        Xoshiro256 gen;
+    };
+
+    // 每个工作线程独立的缓冲区
+    struct Workspace {
+        LocalSearch<> search;
+        std::vector<char> visited;
+        std::vector<double> weight;
+        SpatialGrid unvisited;
+    };
+
+    const CityCoordinates &coords;
+    int n;
+    LocalSearch<> candidates; // 候选邻居表
+    int k;
+    WorkStealingPool pool;
+    int antCount = 25;
+    int maxIterations = 1000;
+    qint64 timeLimitMs = 0;
+    double rho = 0.02;
+    bool localSearchEnabled = true;
+    quint64 seed = 0;
+    const std::atomic<bool> *cancelFlag = nullptr;
+    std::function<void(const Progress &)> callback;
+    Progress progress;
+
+    std::vector<double> heuristic;  // n*k 条候选边的 (1/距离)²
+    std::vector<double> pheromone;  // n*k 条候选边的信息素
+    std::vector<double> choiceInfo; // 信息素 * 启发值, 每轮开始时计算, 构造时只读
+    QList<SpatialGrid::Entry> entries;
+    std::vector<Workspace> workspaces;
+
+    double dist(int a, int b) const { return coords.distance(a, b); }
+
+    // 一只蚂蚁构造回路(并做局部搜索)
+    void constructTour(Ant &ant, Workspace &workspace) const;
+
+    // 所有信息素挥发, 沿 tour 的边增加 amount, 再截断到 [low, high]
+    void updatePheromone(const std::vector<int> &tour, double amount, double low, double high);
+
+    // 在 from 的候选表中给到 to 的边加 amount
+    void deposit(int from, int to, double amount);
+};
+
+#endif // ANTCOLONY_H
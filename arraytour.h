@@ -0,0 +1,65 @@
+#ifndef ARRAYTOUR_H
+#define ARRAYTOUR_H
+
+#include <QtGlobal>
+#include <algorithm>
+#include <vector>
+
+// 数组表示的回路: tour[位置] = 城市, pos[城市] = 位置
+// next/prev 为 O(1); 2-opt 翻转一段路径, 只翻转较短的一侧, 最坏 O(n/2)
+class ArrayTour {
+public:
+    void init(const std::vector<int> &order) {
+        tour = order;
+        n = static_cast<int>(tour.size());
+        pos.assign(n, 0);
+        for (int i = 0; i < n; ++i) pos[tour[i]] = i;
+    }
+
+    int size() const { return n; }
+
+    int next(int city) const { int p = pos[city] + 1; return tour[p == n ? 0 : p]; }
+    int prev(int city) const { int p = pos[city]; return tour[p == 0 ? n - 1 : p - 1]; }
+
+    // 从 a 沿回路方向走到 c 的途中(含两端)是否经过 b
+    bool between(int a, int b, int c) const {
+        int pa = pos[a], pb = pos[b], pc = pos[c];
+        if (pa <= pc) return pa <= pb && pb <= pc;
+        return pb >= pa || pb <= pc;
+    }
+
+    // 2-opt: 要求 next(a) == b, next(c) == d; 删除边 (a,b), (c,d), 加入 (a,c), (b,d)
+    // 翻转 b..c 与翻转 d..a 得到同一条回路(方向相反)
+    void flip(int a, int b, int c, int d) {
+        Q_UNUSED(a);
+        int inner = (pos[c] - pos[b] + n) % n + 1;
+        if (inner * 2 <= n) {
+            reverseRange(pos[b], inner);
+        } else {
+            reverseRange(pos[d], n - inner);
+        }
+    }
+
+    // 从位置 0 开始的城市序列
+    const std::vector<int> &order() const { return tour; }
+
+private:
+    int n = 0;
+    std::vector<int> tour;
+    std::vector<int> pos;
+
+    // 环形翻转从位置 from 开始的 count 个城市
+    void reverseRange(int from, int count) {
+        int left = from;
+        int right = (from + count - 1) % n;
+        for (int k = 0; k < count / 2; ++k) {
+            std::swap(tour[left], tour[right]);
+            pos[tour[left]] = left;
+            pos[tour[right]] = right;
+            left = left + 1 == n ? 0 : left + 1;
+            right = right == 0 ? n - 1 : right - 1;
+        }
+    }
+};
+
+#endif // ARRAYTOUR_H
@@ -0,0 +1,22 @@
+# 基准程序的公共配置: 只依赖 QtCore, 直接编译主程序中与界面无关的源文件
+QT = core
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    $$PWD/../antcolony.cpp \
+    $$PWD/../branchandbound.cpp \
+    $$PWD/../christofides.cpp \
+    $$PWD/../citydatabase.cpp \
+    $$PWD/../cityfileparser.cpp \
+    $$PWD/../citymanager.cpp \
+    $$PWD/../citypool.cpp \
+    $$PWD/../geneticalgorithm.cpp \
+    $$PWD/../linkernighan.cpp \
+    $$PWD/../localsearch.cpp \
+    $$PWD/../spatialgrid.cpp \
+    $$PWD/../threadpool.cpp \
+    $$PWD/../tourconstruction.cpp \
+    $$PWD/../twoleveltour.cpp
@@ -0,0 +1,7 @@
+# 性能基准, 与主程序分开构建: qmake bench/bench.pro && make
+TEMPLATE = subdirs
+
+SUBDIRS += hashbench rangebench tourbench
+hashbench.file = hashbench.pro
+rangebench.file = rangebench.pro
+tourbench.file = tourbench.pro
@@ -0,0 +1,150 @@
+// 城市名称索引的微基准: 原来的 100 桶拉链表与 CityManager 的开放定址表
+// 分别测插入、查找、删除全部城市的用时, 城市名为 "city0".."city<n-1>", 查找和删除按随机顺序进行
+// 用法: hashbench [城市数 ...], 默认 1000 20000 100000 1000000; 旧表超过 OLD_MAX 个城市时太慢, 不测
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "citymanager.h"
+#include "xoshiro256.h"
+
+namespace {
+const int OLD_MAX = 100000;
+
+// 改造前的哈希表: 100 个桶的拉链表, 哈希值是名称各字符编码之和取模, 头插法
+// 与原实现相同, 只去掉了重名/不存在时的控制台输出
+class OldCityTable {
+public:
+    ~OldCityTable() {
+        for (Node *&head : list) {
+            while (head) {
+                Node *next = head->next;
+                delete head;
+                head = next;
+            }
+        }
+    }
+
+    bool addCity(const City &city) {
+        int index = hash(city.name);
+        for (Node *node = list[index]; node; node = node->next) {
+            if (node->city.name == city.name) return false;
+        }
+        Node *node = new Node{city, list[index]};
+        list[index] = node;
+        return true;
+    }
+
+    City findCity(const QString &name) const {
+        for (const Node *node = list[hash(name)]; node; node = node->next) {
+            if (node->city.name == name) return node->city;
+        }
+        return {"", 0, 0};
+    }
+
+    bool removeCity(const QString &name) {
+        int index = hash(name);
+        Node *prev = nullptr;
+        for (Node *node = list[index]; node; prev = node, node = node->next) {
+            if (node->city.name == name) {
+                (prev ? prev->next : list[index]) = node->next;
+                delete node;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static const int HASH_SIZE = 100;
+
+    struct Node {
+        City city;
+        Node *next;
+    };
+
+    Node *list[HASH_SIZE] = {};
+
+    static int hash(const QString &name) {
+        int sum = 0;
+        for (QChar c : name) {
+            sum += c.unicode();
+        }
+        return sum % HASH_SIZE;
+    }
+};
+
+struct Timing {
+    double insertMs;
+    double lookupMs;
+    double removeMs;
+};
+
+// 插入全部城市, 再按打乱的顺序各查找、删除一遍; 结果不对时直接退出
+template <typename Table>
+Timing run(const QList<City> &cities, const QList<int> &order) {
+    Table table;
+    Timing timing;
+    QElapsedTimer timer;
+
+    timer.start();
+    for (const City &city : cities) {
+        table.addCity(city);
+    }
+    timing.insertMs = timer.nsecsElapsed() / 1e6;
+
+    timer.restart();
+    int found = 0;
+    for (int i : order) {
+        found += table.findCity(cities[i].name).x == cities[i].x;
+    }
+    timing.lookupMs = timer.nsecsElapsed() / 1e6;
+
+    timer.restart();
+    int removed = 0;
+    for (int i : order) {
+        removed += table.removeCity(cities[i].name);
+    }
+    timing.removeMs = timer.nsecsElapsed() / 1e6;
+
+    if (found != cities.size() || removed != cities.size()) {
+        std::fprintf(stderr, "结果错误: 找到 %d, 删除 %d, 应为 %d\n", found, removed, int(cities.size()));
+        std::exit(1);
+    }
+    return timing;
+}
+}
+
+int main(int argc, char *argv[]) {
+    QList<int> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.append(std::atoi(argv[i]));
+    }
+    if (sizes.isEmpty()) {
+        sizes = {1000, 20000, 100000, 1000000};
+    }
+
+    std::printf("%10s  %-26s  %-26s\n", "城市数", "旧表 插入/查找/删除 (ms)", "新表 插入/查找/删除 (ms)");
+    for (int n : sizes) {
+        Xoshiro256 rng(n);
+        QList<City> cities;
+        cities.reserve(n);
+        for (int i = 0; i < n; ++i) {
+            cities.append({QString("city%1").arg(i), rng.uniformReal() * 10000, rng.uniformReal() * 10000});
+        }
+        QList<int> order(n);
+        for (int i = 0; i < n; ++i) order[i] = i;
+        std::shuffle(order.begin(), order.end(), rng);
+
+        char oldText[64] = "-";
+        if (n <= OLD_MAX) {
+            Timing old = run<OldCityTable>(cities, order);
+            std::snprintf(oldText, sizeof(oldText), "%.1f / %.1f / %.1f", old.insertMs, old.lookupMs, old.removeMs);
+        }
+        Timing now = run<CityManager>(cities, order);
+        std::printf("%10d  %-26s  %.1f / %.1f / %.1f\n", n, oldText, now.insertMs, now.lookupMs, now.removeMs);
+    }
+    return 0;
+}
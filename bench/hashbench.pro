@@ -0,0 +1,6 @@
+TARGET = hashbench
+TEMPLATE = app
+
+include(bench.pri)
+
+SOURCES += hashbench.cpp
@@ -0,0 +1,100 @@
+// 范围查询的微基准: 原来的线性扫描与 CityManager 的空间网格
+// 城市均匀分布在 10000 x 10000 的正方形内, 先删掉三分之一, 再以随机城市为中心查询半径 RANGE 内的城市
+// 线性扫描与改造前的实现相同: 取出全部城市逐个计算距离
+// 另外用超出网格、超出 int 范围和无穷大的半径各查询一次, 结果必须与线性扫描一致(全部城市)
+// 用法: rangebench [城市数 ...], 默认 10000 100000 1000000
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include "citymanager.h"
+#include "xoshiro256.h"
+
+namespace {
+const double SIDE = 10000;
+const double RANGE = 300;
+const int QUERIES = 100;
+const double HUGE_RANGES[] = {SIDE * 2, 1e12, std::numeric_limits<double>::infinity()};
+
+QList<City> linearWithinRange(const CityManager &manager, const QString &targetCityName, double range) {
+    QList<City> result;
+    City target = manager.findCity(targetCityName);
+    if (target.name.isEmpty()) {
+        return result;
+    }
+    QList<City> allCities = manager.getAllCities();
+    for (const City &city : allCities) {
+        if (city.name == target.name) continue;
+        if (manager.distance(target, city) <= range) {
+            result.append(city);
+        }
+    }
+    return result;
+}
+}
+
+int main(int argc, char *argv[]) {
+    QList<int> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.append(std::atoi(argv[i]));
+    }
+    if (sizes.isEmpty()) {
+        sizes = {10000, 100000, 1000000};
+    }
+
+    std::printf("%10s  %16s  %16s  %10s\n", "城市数", "线性扫描(ms/次)", "空间网格(ms/次)", "平均结果数");
+    for (int n : sizes) {
+        Xoshiro256 rng(n);
+        CityManager manager;
+        for (int i = 0; i < n; ++i) {
+            manager.addCity({QString("city%1").arg(i), rng.uniformReal() * SIDE, rng.uniformReal() * SIDE});
+        }
+        QList<QString> kept;
+        for (int i = 0; i < n; ++i) {
+            if (i % 3 == 0) {
+                manager.removeCity(QString("city%1").arg(i));
+            } else {
+                kept.append(QString("city%1").arg(i));
+            }
+        }
+        QList<QString> targets;
+        for (int q = 0; q < QUERIES; ++q) {
+            targets.append(kept[rng.uniform(static_cast<int>(kept.size()))]);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        qint64 linearCount = 0;
+        for (const QString &name : targets) {
+            linearCount += linearWithinRange(manager, name, RANGE).size();
+        }
+        double linearMs = timer.nsecsElapsed() / 1e6 / QUERIES;
+
+        timer.restart();
+        qint64 gridCount = 0;
+        for (const QString &name : targets) {
+            gridCount += manager.getCitiesWithinRange(name, RANGE).size();
+        }
+        double gridMs = timer.nsecsElapsed() / 1e6 / QUERIES;
+
+        if (linearCount != gridCount) {
+            std::fprintf(stderr, "结果不一致: 线性扫描 %lld, 空间网格 %lld\n", linearCount, gridCount);
+            return 1;
+        }
+        std::printf("%10d  %16.3f  %16.3f  %10.1f\n", n, linearMs, gridMs, double(gridCount) / QUERIES);
+
+        for (double range : HUGE_RANGES) {
+            qsizetype linear = linearWithinRange(manager, targets.first(), range).size();
+            qsizetype grid = manager.getCitiesWithinRange(targets.first(), range).size();
+            if (linear != grid || grid != kept.size() - 1) {
+                std::fprintf(stderr, "半径 %g 结果不一致: 线性扫描 %lld, 空间网格 %lld, 应为 %lld\n", range,
+                             static_cast<long long>(linear), static_cast<long long>(grid),
+                             static_cast<long long>(kept.size() - 1));
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
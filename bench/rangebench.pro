@@ -0,0 +1,6 @@
+TARGET = rangebench
+TEMPLATE = app
+
+include(bench.pri)
+
+SOURCES += rangebench.cpp
@@ -0,0 +1,99 @@
+// 回路表示的微基准: ArrayTour 与 TwoLevelTour
+// 随机翻转: 任取两条边做 2-opt, 被翻转的路径平均很长
+// 局部翻转: 翻转不超过 50 个城市的一段, 再从端点沿回路走 50 步, 与 LK 和局部搜索的访问方式相近
+// next(): 沿回路连续走
+// 用法: tourbench [城市数 ...], 默认 10000 100000 1000000
+#include <QElapsedTimer>
+#include <QList>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+#include "arraytour.h"
+#include "twoleveltour.h"
+#include "xoshiro256.h"
+
+namespace {
+const int RANDOM_FLIPS = 1000;
+const int LOCAL_FLIPS = 100000;
+const int LOCAL_SPAN = 50;
+const int WALK_STEPS = 10000000;
+
+volatile int sink; // 遍历结果写到这里, 防止编译器删掉只读的循环
+
+struct Timing {
+    double randomFlipUs;
+    double localFlipUs;
+    double nextNs;
+};
+
+template <typename Tour>
+Timing run(const std::vector<int> &order, quint64 seed) {
+    int n = static_cast<int>(order.size());
+    Tour tour;
+    tour.init(order);
+    Xoshiro256 gen(seed);
+    Timing timing;
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < RANDOM_FLIPS; ++i) {
+        int a = gen.uniform(n), c = gen.uniform(n);
+        int b = tour.next(a), d = tour.next(c);
+        if (c == a || c == b || d == a) continue;
+        tour.flip(a, b, c, d);
+    }
+    timing.randomFlipUs = timer.nsecsElapsed() / 1e3 / RANDOM_FLIPS;
+
+    timer.restart();
+    for (int i = 0; i < LOCAL_FLIPS; ++i) {
+        int a = gen.uniform(n);
+        int b = tour.next(a);
+        int c = b;
+        for (int steps = gen.uniform(LOCAL_SPAN); steps > 0; --steps) c = tour.next(c);
+        int d = tour.next(c);
+        if (d == a) continue;
+        tour.flip(a, b, c, d);
+        int city = a;
+        for (int steps = 0; steps < LOCAL_SPAN; ++steps) city = tour.next(city);
+        sink = city;
+    }
+    timing.localFlipUs = timer.nsecsElapsed() / 1e3 / LOCAL_FLIPS;
+
+    timer.restart();
+    int city = 0;
+    for (int i = 0; i < WALK_STEPS; ++i) city = tour.next(city);
+    timing.nextNs = static_cast<double>(timer.nsecsElapsed()) / WALK_STEPS;
+    sink = city;
+    return timing;
+}
+}
+
+int main(int argc, char *argv[]) {
+    QList<int> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.append(std::atoi(argv[i]));
+    }
+    if (sizes.isEmpty()) {
+        sizes = {10000, 100000, 1000000};
+    }
+
+    std::printf("%10s  %-12s  %16s  %16s  %12s\n", "城市数", "回路表示", "随机翻转(us/次)", "局部翻转(us/次)",
+                "next(ns/次)");
+    for (int n : sizes) {
+        // 随机排列作为初始回路, 相邻城市的编号不相邻
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        Xoshiro256 gen(n);
+        std::shuffle(order.begin(), order.end(), gen);
+
+        Timing array = run<ArrayTour>(order, n);
+        Timing twoLevel = run<TwoLevelTour>(order, n);
+        std::printf("%10d  %-12s  %16.2f  %16.2f  %12.2f\n", n, "ArrayTour", array.randomFlipUs, array.localFlipUs,
+                    array.nextNs);
+        std::printf("%10s  %-12s  %16.2f  %16.2f  %12.2f\n", "", "TwoLevelTour", twoLevel.randomFlipUs,
+                    twoLevel.localFlipUs, twoLevel.nextNs);
+    }
+    return 0;
+}
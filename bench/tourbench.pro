@@ -0,0 +1,6 @@
+TARGET = tourbench
+TEMPLATE = app
+
+include(bench.pri)
+
+SOURCES += tourbench.cpp
@@ -0,0 +1,430 @@
+#include "branchandbound.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace {
+const double INF = std::numeric_limits<double>::max();
+}
+
+BranchAndBound::BranchAndBound(const DistanceMatrix<double> &matrix)
+    : dist(matrix.data()), n(matrix.size()), upperBound(INF) {
+}
+
+void BranchAndBound::setProgressCallback(std::function<void(const Progress &)> callback, qint64 intervalMs) {
+    this->callback = std::move(callback);
+    callbackIntervalMs = intervalMs;
+}
+
+void BranchAndBound::setInitialTour(const std::vector<int> &tour) {
+    bestTour = tour;
+    upperBound = tourLength(tour);
+}
+
+// 回路长度
+double BranchAndBound::tourLength(const std::vector<int> &tour) const {
+    double total = 0;
+    for (int i = 0; i < static_cast<int>(tour.size()); ++i) {
+        total += dist[tour[i] * n + tour[(i + 1) % tour.size()]];
+    }
+    return total;
+}
+
+// 把约束列表应用到边状态矩阵
+void BranchAndBound::applyConstraints(const std::vector<std::pair<int, char>> &constraints) {
+    std::fill(state.begin(), state.end(), Free);
+    for (const auto &constraint : constraints) {
+        int a = constraint.first / n;
+        int b = constraint.first % n;
+        state[a * n + b] = constraint.second;
+        state[b * n + a] = constraint.second;
+    }
+}
+
+// 在当前边状态和罚值下求最小 1-tree
+// 强制边在 Prim 中优先于任何普通边, 得到的是包含全部强制边的最小生成树
+BranchAndBound::OneTree BranchAndBound::computeOneTree(const std::vector<double> &pi) const {
+    OneTree tree;
+    tree.degree.assign(n, 0);
+    tree.edges.reserve(n);
+
+    std::vector<double> key(n, INF);
+    std::vector<char> keyForced(n, 0);
+    std::vector<int> parent(n, -1);
+    std::vector<char> inTree(n, 0);
+
+    // 1..n-1 号城市上的 Prim 算法, 从 1 号城市开始
+    int forcedInTree = 0;
+    int current = 1;
+    inTree[1] = 1;
+    for (int added = 1; added < n - 1; ++added) {
+        for (int w = 1; w < n; ++w) {
+            if (inTree[w]) continue;
+            char s = state[current * n + w];
+            if (s == Excluded) continue;
+            double cost = dist[current * n + w] + pi[current] + pi[w];
+            if (s == Forced) {
+                if (!keyForced[w] || cost < key[w]) {
+                    keyForced[w] = 1;
+                    key[w] = cost;
+                    parent[w] = current;
+                }
+            } else if (!keyForced[w] && cost < key[w]) {
+                key[w] = cost;
+                parent[w] = current;
+            }
+        }
+
+        int next = -1;
+        for (int w = 1; w < n; ++w) {
+            if (inTree[w] || parent[w] < 0) continue;
+            if (next < 0 || keyForced[w] > keyForced[next]
+                || (keyForced[w] == keyForced[next] && key[w] < key[next])) {
+                next = w;
+            }
+        }
+        if (next < 0) return tree; // 排除的边太多, 图不连通
+
+        inTree[next] = 1;
+        tree.edges.emplace_back(parent[next], next);
+        tree.degree[parent[next]]++;
+        tree.degree[next]++;
+        tree.bound += key[next];
+        if (keyForced[next]) forcedInTree++;
+        current = next;
+    }
+
+    // 强制边成环时无法全部放进生成树, 该子问题无解
+    int forcedTotal = 0;
+    for (int a = 1; a < n; ++a) {
+        for (int b = a + 1; b < n; ++b) {
+            if (state[a * n + b] == Forced) forcedTotal++;
+        }
+    }
+    if (forcedInTree != forcedTotal) return tree;
+
+    // 0 号城市先接强制边, 再接最短的普通边, 共两条
+    int chosen[2] = {-1, -1};
+    int chosenCount = 0;
+    for (int w = 1; w < n && chosenCount < 2; ++w) {
+        if (state[w] == Forced) chosen[chosenCount++] = w;
+    }
+    while (chosenCount < 2) {
+        int best = -1;
+        double bestCost = INF;
+        for (int w = 1; w < n; ++w) {
+            if (state[w] != Free || w == chosen[0]) continue;
+            double cost = dist[w] + pi[0] + pi[w];
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = w;
+            }
+        }
+        if (best < 0) return tree;
+        chosen[chosenCount++] = best;
+    }
+    for (int w : chosen) {
+        tree.edges.emplace_back(0, w);
+        tree.degree[0]++;
+        tree.degree[w]++;
+        tree.bound += dist[w] + pi[0] + pi[w];
+    }
+
+    for (int i = 0; i < n; ++i) {
+        tree.bound -= 2 * pi[i];
+    }
+    tree.feasible = true;
+    return tree;
+}
+
+// 次梯度法: pi[i] += t * (degree[i] - 2), 度数大于 2 的城市变"贵", 度数为 1 的城市变"便宜"
+BranchAndBound::OneTree BranchAndBound::ascend(std::vector<double> &pi, int iterations, double initialStep) {
+    OneTree best;
+    best.bound = -INF;
+    std::vector<double> bestPi = pi;
+    double step = initialStep;
+    int sinceImprovement = 0;
+    int patience = qMax(5, iterations / 10);
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        OneTree tree = computeOneTree(pi);
+        if (!tree.feasible) return tree;
+
+        if (tree.bound > best.bound) {
+            best = tree;
+            bestPi = pi;
+            sinceImprovement = 0;
+        } else {
+            sinceImprovement++;
+        }
+
+        double norm = 0;
+        for (int i = 0; i < n; ++i) {
+            int g = tree.degree[i] - 2;
+            norm += g * g;
+        }
+        if (norm == 0) {
+            // 1-tree 本身就是回路, 它就是该子问题的最优解
+            best = tree;
+            bestPi = pi;
+            break;
+        }
+        if (best.bound >= upperBound * (1 - 1e-12)) break; // 已可剪枝
+        if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) break; // 任意罚值下的 1-tree 都是下界
+
+        double t = step * (upperBound - tree.bound) / norm;
+        for (int i = 0; i < n; ++i) {
+            pi[i] += t * (tree.degree[i] - 2);
+        }
+
+        if (sinceImprovement >= patience) {
+            step /= 2;
+            sinceImprovement = 0;
+            if (step < 1e-5) break;
+        }
+    }
+
+    pi = bestPi;
+    return best;
+}
+
+// 强制边 (a, b), 并传播约束:
+// 度数达到 2 的城市排除其余所有边; 强制路径的两个端点之间的边会提前形成子回路, 也排除
+bool BranchAndBound::force(int a, int b, std::vector<std::pair<int, char>> &constraints) {
+    char s = state[a * n + b];
+    if (s == Forced) return true;
+    if (s == Excluded) return false;
+
+    auto forcedDegree = [this](int v) {
+        int degree = 0;
+        for (int w = 0; w < n; ++w) {
+            if (w != v && state[v * n + w] == Forced) degree++;
+        }
+        return degree;
+    };
+    if (forcedDegree(a) >= 2 || forcedDegree(b) >= 2) return false;
+
+    // 沿强制边走到路径的另一端, 返回端点和边数
+    auto walk = [this](int from, int avoid, int &length) {
+        int prev = avoid, current = from;
+        length = 0;
+        while (true) {
+            int next = -1;
+            for (int w = 0; w < n; ++w) {
+                if (w != current && w != prev && state[current * n + w] == Forced) {
+                    next = w;
+                    break;
+                }
+            }
+            if (next < 0 || next == from) return current;
+            prev = current;
+            current = next;
+            length++;
+        }
+    };
+
+    int lengthA = 0, lengthB = 0;
+    int endA = walk(a, b, lengthA);
+    int endB = walk(b, a, lengthB);
+    int pathEdges = lengthA + lengthB + 1;
+    if (endA == b && pathEdges < n) return false; // 会形成子回路
+
+    state[a * n + b] = state[b * n + a] = Forced;
+    constraints.emplace_back(qMin(a, b) * n + qMax(a, b), Forced);
+
+    for (int v : {a, b}) {
+        if (forcedDegree(v) == 2) {
+            for (int w = 0; w < n; ++w) {
+                if (w != v && state[v * n + w] == Free) exclude(v, w, constraints);
+            }
+        }
+    }
+    if (pathEdges < n - 1 && state[endA * n + endB] == Free) {
+        exclude(endA, endB, constraints);
+    }
+    return true;
+}
+
+// 排除边 (a, b)
+void BranchAndBound::exclude(int a, int b, std::vector<std::pair<int, char>> &constraints) {
+    if (state[a * n + b] != Free) return;
+    state[a * n + b] = state[b * n + a] = Excluded;
+    constraints.emplace_back(qMin(a, b) * n + qMax(a, b), Excluded);
+}
+
+// 所有城市度数为 2 的 1-tree 转换为回路
+std::vector<int> BranchAndBound::treeToTour(const OneTree &tree) const {
+    std::vector<std::vector<int>> adjacent(n);
+    for (const auto &edge : tree.edges) {
+        adjacent[edge.first].push_back(edge.second);
+        adjacent[edge.second].push_back(edge.first);
+    }
+    std::vector<int> tour;
+    int prev = -1, current = 0;
+    for (int i = 0; i < n; ++i) {
+        tour.push_back(current);
+        int next = adjacent[current][0] != prev ? adjacent[current][0] : adjacent[current][1];
+        prev = current;
+        current = next;
+    }
+    return tour;
+}
+
+// 最优优先的分支定界
+std::vector<int> BranchAndBound::solve() {
+    QElapsedTimer timer;
+    timer.start();
+    optimal = false;
+    progress = Progress();
+
+    if (n <= 3) {
+        bestTour.clear();
+        for (int i = 0; i < n; ++i) bestTour.push_back(i);
+        upperBound = tourLength(bestTour);
+        optimal = true;
+        progress.lowerBound = progress.upperBound = upperBound;
+        return bestTour;
+    }
+
+    // 没有给初始回路时用最近邻回路作为上界
+    if (bestTour.empty()) {
+        std::vector<char> visited(n, 0);
+        int current = 0;
+        visited[0] = 1;
+        bestTour.push_back(0);
+        for (int step = 1; step < n; ++step) {
+            int next = -1;
+            for (int w = 0; w < n; ++w) {
+                if (!visited[w] && (next < 0 || dist[current * n + w] < dist[current * n + next])) next = w;
+            }
+            visited[next] = 1;
+            bestTour.push_back(next);
+            current = next;
+        }
+        upperBound = tourLength(bestTour);
+    }
+
+    auto compare = [](const Node *a, const Node *b) { return a->bound > b->bound; };
+    std::priority_queue<Node *, std::vector<Node *>, decltype(compare)> open(compare);
+
+    state.assign(n * n, Free);
+    Node *root = new Node{-INF, {}, std::vector<double>(n, 0.0)};
+    open.push(root);
+
+    qint64 lastReport = -callbackIntervalMs;
+    double lowerBound = -INF;
+    bool timedOut = false;
+    bool rootDone = false;
+
+    auto report = [&](bool improved) {
+        progress.elapsedMs = timer.elapsed();
+        progress.openNodes = static_cast<qint64>(open.size());
+        progress.nodesPerSecond = progress.nodes * 1000.0 / qMax<qint64>(1, progress.elapsedMs);
+        progress.upperBound = upperBound;
+        // 所有未找到的更优解都在待处理节点中, 待处理节点的最小下界就是全局下界
+        if (!open.empty()) lowerBound = qMax(lowerBound, open.top()->bound);
+        progress.lowerBound = qMin(qMax(lowerBound, 0.0), upperBound);
+        progress.gap = upperBound > 0 ? (upperBound - progress.lowerBound) / upperBound : 0;
+        progress.improved = improved;
+        lastReport = progress.elapsedMs;
+        if (callback) {
+            progress.tour = &bestTour;
+            callback(progress);
+            progress.tour = nullptr;
+        }
+    };
+
+    while (!open.empty()) {
+        if ((timeLimitMs > 0 && timer.elapsed() >= timeLimitMs)
+            || (cancelFlag && cancelFlag->load(std::memory_order_relaxed))) {
+            timedOut = true;
+            break;
+        }
+
+        Node *node = open.top();
+        open.pop();
+        // 最优优先: 取出的节点下界单调不减, 即为全局下界
+        lowerBound = qMax(lowerBound, node->bound);
+        if (node->bound >= upperBound * (1 - 1e-12)) {
+            delete node;
+            continue;
+        }
+
+        applyConstraints(node->constraints);
+        std::vector<double> pi = node->pi;
+        // 根节点多做迭代得到好的罚值, 子节点从父节点的罚值热启动
+        OneTree tree = rootDone ? ascend(pi, 30 + n / 2, 1.0) : ascend(pi, qMax(200, 20 * n), 2.0);
+        rootDone = true;
+        progress.nodes++;
+
+        bool improved = false;
+        if (tree.feasible && tree.bound < upperBound * (1 - 1e-12)) {
+            bool isTour = std::all_of(tree.degree.begin(), tree.degree.end(), [](int d) { return d == 2; });
+            if (isTour) {
+                std::vector<int> tour = treeToTour(tree);
+                double length = tourLength(tour);
+                if (length < upperBound) {
+                    upperBound = length;
+                    bestTour = tour;
+                    improved = true;
+                }
+            } else {
+                // 选择度数最大的城市分支
+                int v = 0;
+                for (int i = 1; i < n; ++i) {
+                    if (tree.degree[i] > tree.degree[v]) v = i;
+                }
+                std::vector<int> freeNeighbors;
+                int forcedAtV = 0;
+                for (const auto &edge : tree.edges) {
+                    if (edge.first != v && edge.second != v) continue;
+                    int w = edge.first == v ? edge.second : edge.first;
+                    if (state[v * n + w] == Forced) forcedAtV++;
+                    else freeNeighbors.push_back(w);
+                }
+                // 罚值调整后代价大的边优先排除
+                std::sort(freeNeighbors.begin(), freeNeighbors.end(), [&](int a, int b) {
+                    return dist[v * n + a] + pi[a] > dist[v * n + b] + pi[b];
+                });
+
+                // 子问题: 不含 e1; 含 e1 不含 e2; 含 e1 和 e2 (v 已有一条强制边时只有前两种)
+                int childCount = forcedAtV == 0 ? 3 : 2;
+                for (int child = 0; child < childCount && freeNeighbors.size() >= 2; ++child) {
+                    applyConstraints(node->constraints);
+                    std::vector<std::pair<int, char>> constraints = node->constraints;
+                    bool ok = true;
+                    if (child == 0) {
+                        exclude(v, freeNeighbors[0], constraints);
+                    } else {
+                        ok = force(v, freeNeighbors[0], constraints);
+                        if (ok && child == 1 && forcedAtV == 0) {
+                            exclude(v, freeNeighbors[1], constraints);
+                        } else if (ok && child == 2) {
+                            ok = force(v, freeNeighbors[1], constraints);
+                        }
+                    }
+                    if (ok) {
+                        open.push(new Node{tree.bound, std::move(constraints), pi});
+                    }
+                }
+            }
+        }
+        delete node;
+
+        if (improved || timer.elapsed() - lastReport >= callbackIntervalMs) {
+            report(improved);
+        }
+    }
+
+    optimal = !timedOut;
+    if (optimal) lowerBound = upperBound;
+    report(false);
+
+    while (!open.empty()) {
+        delete open.top();
+        open.pop();
+    }
+    return bestTour;
+}
@@ -0,0 +1,100 @@
+#ifndef BRANCHANDBOUND_H
+#define BRANCHANDBOUND_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "distancematrix.h"
+
+// 分支定界精确求解器
+// 下界使用 Held-Karp 1-tree: 去掉 0 号城市后求最小生成树, 再把 0 号城市用最短的两条边接上;
+// 通过次梯度法调整每个城市的罚值 pi, 使 1-tree 尽量接近一条回路, 下界尽量紧;
+// 分支时选 1-tree 中度数大于 2 的城市, 按"排除/强制"它的树边把问题划分成互不重叠的子问题
+class BranchAndBound {
+public:
+    // 进度信息
+    struct Progress {
+        qint64 nodes = 0;          // 已处理的搜索树节点
+        qint64 openNodes = 0;      // 待处理的节点
+        double nodesPerSecond = 0; // 每秒处理的节点数
+        double lowerBound = 0;     // 全局下界
+        double upperBound = 0;     // 当前最优回路长度
+        double gap = 0;            // (上界 - 下界) / 上界
+        qint64 elapsedMs = 0;      // 已用时间
+        bool improved = false;     // 本次是否找到了更优回路
+        const std::vector<int> *tour = nullptr; // 当前最优回路, 只在回调期间有效
+    };
+
+    // 距离矩阵需在求解期间保持有效
+    explicit BranchAndBound(const DistanceMatrix<double> &matrix);
+
+    // 时间上限(毫秒), 0 表示不限制; 超时返回当前最优回路
+    void setTimeLimit(qint64 ms) { timeLimitMs = ms; }
+
+    // 取消标志, 置位后与超时一样返回当前最优回路
+    void setCancelFlag(const std::atomic<bool> *flag) { cancelFlag = flag; }
+
+    // 进度回调, 找到更优回路时以及每隔 intervalMs 毫秒调用一次
+    void setProgressCallback(std::function<void(const Progress &)> callback, qint64 intervalMs = 500);
+
+    // 用启发式回路作为初始上界(城市编号序列)
+    void setInitialTour(const std::vector<int> &tour);
+
+    // 求解, 返回回路的城市编号序列(不重复起点)
+    std::vector<int> solve();
+
+    // 是否证明了最优(未超时)
+    bool isOptimal() const { return optimal; }
+    const Progress &lastProgress() const { return progress; }
+
+private:
+    enum EdgeState : char { Free = 0, Forced = 1, Excluded = 2 };
+
+    // 搜索树节点: 记录相对根节点的全部边约束, 以及继承给子节点的罚值
+    struct Node {
+        double bound;
+        std::vector<std::pair<int, char>> constraints; // (边编号 i*n+j, 状态)
+        std::vector<double> pi;
+    };
+
+    // 1-tree 计算结果
+    struct OneTree {
+        double bound = 0;
+        std::vector<int> degree;
+        std::vector<std::pair<int, int>> edges;
+        bool feasible = false;
+    };
+
+    const double *dist; // 稠密距离矩阵, 行优先 n*n
+    int n;
+    qint64 timeLimitMs = 0;
+    std::function<void(const Progress &)> callback;
+    qint64 callbackIntervalMs = 500;
+    const std::atomic<bool> *cancelFlag = nullptr;
+
+    std::vector<int> bestTour;
+    double upperBound;
+    bool optimal = false;
+    Progress progress;
+
+    std::vector<char> state; // 当前节点的边状态矩阵
+
+    // 在当前边状态和罚值下求最小 1-tree
+    OneTree computeOneTree(const std::vector<double> &pi) const;
+
+    // 次梯度法提升下界, pi 为热启动值并返回最优罚值
+    OneTree ascend(std::vector<double> &pi, int iterations, double initialStep);
+
+    // 强制一条边并做约束传播, 产生矛盾时返回 false
+    bool force(int a, int b, std::vector<std::pair<int, char>> &constraints);
+    void exclude(int a, int b, std::vector<std::pair<int, char>> &constraints);
+
+    // 1-tree 恰好是一条回路时取出城市序列
+    std::vector<int> treeToTour(const OneTree &tree) const;
+
+    double tourLength(const std::vector<int> &tour) const;
+    void applyConstraints(const std::vector<std::pair<int, char>> &constraints);
+};
+
+#endif // BRANCHANDBOUND_H
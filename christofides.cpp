@@ -0,0 +1,322 @@
+#include "christofides.h"
+#include "disjointset.h"
+#include "spatialgrid.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+const double EPS = 1e-10; // 小于该值的改进视为舍入误差
+
+} // namespace
+
+Christofides::Christofides(const CityCoordinates &coords, int neighborCount)
+    : coords(coords), n(coords.size()), neighborCount(qMax(1, neighborCount)) {
+}
+
+// 完全图上的 Prim, 距离按坐标现算, 不需要距离矩阵
+std::vector<std::pair<int, int>> Christofides::denseMst() const {
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(n - 1);
+    std::vector<double> key(n, std::numeric_limits<double>::max());
+    std::vector<int> parent(n, -1);
+    std::vector<char> inTree(n, 0);
+
+    int current = 0;
+    inTree[0] = 1;
+    for (int added = 1; added < n; ++added) {
+        int next = -1;
+        for (int v = 0; v < n; ++v) {
+            if (inTree[v]) continue;
+            double d = dist(current, v);
+            if (d < key[v]) {
+                key[v] = d;
+                parent[v] = current;
+            }
+            if (next < 0 || key[v] < key[next]) next = v;
+        }
+        inTree[next] = 1;
+        edges.push_back({parent[next], next});
+        current = next;
+    }
+    return edges;
+}
+
+// k 近邻图上的 Kruskal; 近邻图不连通时, 从最大的分量开始, 每次用空间网格找其余分量到已连通部分的最短边
+std::vector<std::pair<int, int>> Christofides::sparseMst() const {
+    QList<SpatialGrid::Entry> entries;
+    entries.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        entries.append({coords.x[i], coords.y[i], i});
+    }
+    SpatialGrid grid;
+    grid.build(entries);
+
+    struct Edge {
+        double length;
+        int a, b;
+        bool operator<(const Edge &other) const {
+            if (length != other.length) return length < other.length;
+            if (a != other.a) return a < other.a;
+            return b < other.b;
+        }
+    };
+    int k = qMin(neighborCount, n - 1);
+    std::vector<Edge> candidates;
+    candidates.reserve(static_cast<size_t>(n) * k);
+    for (int i = 0; i < n; ++i) {
+        for (int j : grid.nearest(coords.x[i], coords.y[i], k + 1)) {
+            if (j != i) candidates.push_back({dist(i, j), qMin(i, j), qMax(i, j)});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(n - 1);
+    DisjointSet components(n);
+    for (const Edge &edge : candidates) {
+        if (components.unite(edge.a, edge.b)) edges.push_back({edge.a, edge.b});
+    }
+    if (static_cast<int>(edges.size()) == n - 1) return edges;
+
+    // 按分量分组, 从大到小连接
+    std::vector<std::vector<int>> groups(n);
+    for (int i = 0; i < n; ++i) groups[components.find(i)].push_back(i);
+    std::vector<int> roots;
+    for (int i = 0; i < n; ++i) {
+        if (!groups[i].empty()) roots.push_back(i);
+    }
+    std::sort(roots.begin(), roots.end(), [&](int a, int b) {
+        return groups[a].size() != groups[b].size() ? groups[a].size() > groups[b].size() : a < b;
+    });
+
+    QList<SpatialGrid::Entry> connectedEntries;
+    for (int city : groups[roots[0]]) {
+        connectedEntries.append({coords.x[city], coords.y[city], city});
+    }
+    SpatialGrid connected;
+    connected.build(connectedEntries);
+    for (size_t r = 1; r < roots.size(); ++r) {
+        double best = std::numeric_limits<double>::max();
+        std::pair<int, int> bridge(-1, -1);
+        for (int city : groups[roots[r]]) {
+            int other = connected.nearest(coords.x[city], coords.y[city], 1).first();
+            double d = dist(city, other);
+            if (d < best) {
+                best = d;
+                bridge = {other, city};
+            }
+        }
+        edges.push_back(bridge);
+        for (int city : groups[roots[r]]) {
+            connected.insert(city, coords.x[city], coords.y[city]);
+        }
+    }
+    return edges;
+}
+
+// 状态压缩动态规划: 每次把编号最小的未匹配顶点与另一个未匹配顶点配对
+std::vector<std::pair<int, int>> Christofides::exactMatching(const std::vector<int> &odd) const {
+    int m = static_cast<int>(odd.size());
+    std::vector<double> weight(static_cast<size_t>(m) * m);
+    for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < m; ++j) weight[i * m + j] = dist(odd[i], odd[j]);
+    }
+
+    const quint32 full = (1u << m) - 1;
+    std::vector<double> cost(static_cast<size_t>(full) + 1, std::numeric_limits<double>::max());
+    std::vector<quint16> choice(static_cast<size_t>(full) + 1, 0); // 最后一次配对的 i * 32 + j
+    cost[0] = 0;
+    for (quint32 mask = 0; mask < full; ++mask) {
+        if (cost[mask] == std::numeric_limits<double>::max()) continue;
+        int i = 0;
+        while (mask & (1u << i)) i++;
+        for (int j = i + 1; j < m; ++j) {
+            if (mask & (1u << j)) continue;
+            quint32 next = mask | (1u << i) | (1u << j);
+            double c = cost[mask] + weight[i * m + j];
+            if (c < cost[next]) {
+                cost[next] = c;
+                choice[next] = static_cast<quint16>(i * 32 + j);
+            }
+        }
+    }
+
+    std::vector<std::pair<int, int>> pairs;
+    for (quint32 mask = full; mask != 0;) {
+        int i = choice[mask] / 32;
+        int j = choice[mask] % 32;
+        pairs.push_back({odd[i], odd[j]});
+        mask &= ~((1u << i) | (1u << j));
+    }
+    return pairs;
+}
+
+// 贪心匹配: 奇度顶点之间的 k 近邻边按长度从短到长取, 剩下的顶点依次与最近的未匹配顶点配对;
+// 再反复尝试把相邻的两条匹配边 (a,b), (c,d) 换成 (a,c), (b,d), 直到不再变短
+std::vector<std::pair<int, int>> Christofides::greedyMatching(const std::vector<int> &odd) const {
+    int m = static_cast<int>(odd.size());
+    QList<SpatialGrid::Entry> entries;
+    entries.reserve(m);
+    for (int city : odd) {
+        entries.append({coords.x[city], coords.y[city], city});
+    }
+    SpatialGrid grid;
+    grid.build(entries);
+
+    int k = qMin(neighborCount, m - 1);
+    std::vector<int> candidates(static_cast<size_t>(m) * k, -1);
+    std::vector<std::pair<double, std::pair<int, int>>> edges;
+    edges.reserve(static_cast<size_t>(m) * k);
+    for (int i = 0; i < m; ++i) {
+        int a = odd[i];
+        int count = 0;
+        for (int b : grid.nearest(coords.x[a], coords.y[a], k + 1)) {
+            if (b == a || count == k) continue;
+            candidates[static_cast<size_t>(i) * k + count++] = b;
+            edges.push_back({dist(a, b), {qMin(a, b), qMax(a, b)}});
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<int> mate(n, -1);
+    for (const auto &edge : edges) {
+        int a = edge.second.first;
+        int b = edge.second.second;
+        if (mate[a] < 0 && mate[b] < 0) {
+            mate[a] = b;
+            mate[b] = a;
+        }
+    }
+
+    // 候选边用完后剩下的顶点
+    QList<SpatialGrid::Entry> left;
+    for (int city : odd) {
+        if (mate[city] < 0) left.append({coords.x[city], coords.y[city], city});
+    }
+    SpatialGrid leftGrid;
+    leftGrid.build(left);
+    for (const SpatialGrid::Entry &entry : left) {
+        if (mate[entry.id] >= 0) continue;
+        leftGrid.remove(entry.id, entry.x, entry.y);
+        int other = leftGrid.nearest(entry.x, entry.y, 1).first();
+        leftGrid.remove(other, coords.x[other], coords.y[other]);
+        mate[entry.id] = other;
+        mate[other] = entry.id;
+    }
+
+    bool improved = true;
+    for (int pass = 0; improved && pass < 20; ++pass) {
+        improved = false;
+        for (int i = 0; i < m; ++i) {
+            int a = odd[i];
+            for (int t = 0; t < k; ++t) {
+                int c = candidates[static_cast<size_t>(i) * k + t];
+                if (c < 0) break;
+                int b = mate[a];
+                if (c == b) continue;
+                int d = mate[c];
+                if (dist(a, c) + dist(b, d) < dist(a, b) + dist(c, d) - EPS) {
+                    mate[a] = c;
+                    mate[c] = a;
+                    mate[b] = d;
+                    mate[d] = b;
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    std::vector<std::pair<int, int>> pairs;
+    pairs.reserve(m / 2);
+    for (int city : odd) {
+        if (city < mate[city]) pairs.push_back({city, mate[city]});
+    }
+    return pairs;
+}
+
+// Hierholzer 算法求欧拉回路, 按首次出现的顺序保留城市
+std::vector<int> Christofides::shortcutEulerTour(const std::vector<std::pair<int, int>> &edges) const {
+    std::vector<int> offset(n + 1, 0);
+    for (const auto &edge : edges) {
+        offset[edge.first + 1]++;
+        offset[edge.second + 1]++;
+    }
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+    std::vector<int> incident(offset[n]);
+    std::vector<int> fill(offset.begin(), offset.end() - 1);
+    for (int e = 0; e < static_cast<int>(edges.size()); ++e) {
+        incident[fill[edges[e].first]++] = e;
+        incident[fill[edges[e].second]++] = e;
+    }
+
+    std::vector<char> used(edges.size(), 0);
+    std::vector<int> cursor(offset.begin(), offset.end() - 1);
+    std::vector<char> visited(n, 0);
+    std::vector<int> tour;
+    tour.reserve(n);
+
+    // 回路按出栈顺序生成(方向相反), 不影响抄近路的结果
+    std::vector<int> stack = {0};
+    while (!stack.empty()) {
+        int v = stack.back();
+        while (cursor[v] < offset[v + 1] && used[incident[cursor[v]]]) cursor[v]++;
+        if (cursor[v] == offset[v + 1]) {
+            stack.pop_back();
+            if (!visited[v]) {
+                visited[v] = 1;
+                tour.push_back(v);
+            }
+            continue;
+        }
+        int e = incident[cursor[v]];
+        used[e] = 1;
+        stack.push_back(edges[e].first == v ? edges[e].second : edges[e].first);
+    }
+    return tour;
+}
+
+std::vector<int> Christofides::solve() {
+    stats = Stats();
+    std::vector<int> tour;
+    if (n <= 3) {
+        for (int i = 0; i < n; ++i) tour.push_back(i);
+        return tour;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    stats.exactMst = n <= denseLimit;
+    std::vector<std::pair<int, int>> edges = stats.exactMst ? denseMst() : sparseMst();
+    std::vector<int> degree(n, 0);
+    for (const auto &edge : edges) {
+        stats.mstWeight += dist(edge.first, edge.second);
+        degree[edge.first]++;
+        degree[edge.second]++;
+    }
+    stats.mstMs = timer.restart();
+
+    std::vector<int> odd;
+    for (int i = 0; i < n; ++i) {
+        if (degree[i] % 2 == 1) odd.push_back(i);
+    }
+    stats.oddVertices = static_cast<int>(odd.size());
+    stats.exactMatching = stats.oddVertices <= exactMatchingLimit;
+    std::vector<std::pair<int, int>> matching = stats.exactMatching ? exactMatching(odd) : greedyMatching(odd);
+    for (const auto &pair : matching) {
+        stats.matchingWeight += dist(pair.first, pair.second);
+    }
+    stats.matchingMs = timer.restart();
+
+    edges.insert(edges.end(), matching.begin(), matching.end());
+    stats.eulerLength = stats.mstWeight + stats.matchingWeight;
+    tour = shortcutEulerTour(edges);
+    for (int i = 0; i < n; ++i) {
+        stats.tourLength += dist(tour[i], tour[(i + 1) % n]);
+    }
+    stats.tourMs = timer.elapsed();
+    return tour;
+}
@@ -0,0 +1,64 @@
+#ifndef CHRISTOFIDES_H
+#define CHRISTOFIDES_H
+
+#include <QtGlobal>
+#include <vector>
+#include "distancematrix.h"
+
+// Christofides 算法: 最小生成树 + 奇度顶点的最小权完美匹配 + 欧拉回路抄近路
+// 匹配精确时回路长度不超过最优解的 1.5 倍; 最小生成树的权重是最优回路长度的下界, 可以据此估计误差.
+// 城市不多时用完全图上的 Prim 求精确的最小生成树, 多时用 k 近邻图上的 Kruskal, 再把剩余的连通分量接起来;
+// 奇度顶点不多时用状态压缩动态规划求精确匹配, 多时先贪心匹配再用交换两条匹配边的局部搜索改进
+class Christofides {
+public:
+    // 各阶段的结果和用时
+    struct Stats {
+        double mstWeight = 0;       // 最小生成树权重(最优回路长度的下界, 生成树精确时有效)
+        bool exactMst = false;      // 最小生成树是否精确
+        int oddVertices = 0;        // 奇度顶点数
+        double matchingWeight = 0;  // 匹配权重
+        bool exactMatching = false; // 匹配是否精确
+        double eulerLength = 0;     // 欧拉回路长度(生成树 + 匹配)
+        double tourLength = 0;      // 抄近路后的回路长度
+        qint64 mstMs = 0;
+        qint64 matchingMs = 0;
+        qint64 tourMs = 0;
+    };
+
+    // 坐标需在对象使用期间保持有效
+    explicit Christofides(const CityCoordinates &coords, int neighborCount = 10);
+
+    // 城市数不超过 limit 时用完全图求精确的最小生成树, O(n²)
+    void setDenseLimit(int limit) { denseLimit = limit; }
+
+    // 奇度顶点数不超过 limit 时求精确匹配, O(2^m · m), limit 不超过 24
+    void setExactMatchingLimit(int limit) { exactMatchingLimit = qBound(0, limit, 24); }
+
+    // 返回城市编号序列
+    std::vector<int> solve();
+
+    const Stats &lastStats() const { return stats; }
+
+private:
+    const CityCoordinates &coords;
+    int n;
+    int neighborCount;
+    int denseLimit = 5000;
+    int exactMatchingLimit = 20;
+    Stats stats;
+
+    double dist(int a, int b) const { return coords.distance(a, b); }
+
+    // 最小生成树的边, 每条边 (u, v)
+    std::vector<std::pair<int, int>> denseMst() const;
+    std::vector<std::pair<int, int>> sparseMst() const;
+
+    // 奇度顶点的完美匹配
+    std::vector<std::pair<int, int>> exactMatching(const std::vector<int> &odd) const;
+    std::vector<std::pair<int, int>> greedyMatching(const std::vector<int> &odd) const;
+
+    // 多重图的欧拉回路抄近路, 得到哈密顿回路
+    std::vector<int> shortcutEulerTour(const std::vector<std::pair<int, int>> &edges) const;
+};
+
+#endif // CHRISTOFIDES_H
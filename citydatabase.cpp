@@ -0,0 +1,254 @@
+#include "citydatabase.h"
+#include <QSaveFile>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+const char MAGIC[8] = {'T', 'S', 'P', 'C', 'I', 'T', 'Y', '\0'};
+const quint32 ENDIAN_MARK = 0x01020304;
+
+quint64 align8(quint64 bytes) {
+    return (bytes + 7) & ~quint64(7);
+}
+
+bool fail(QString *error, const QString &message) {
+    if (error) *error = message;
+    return false;
+}
+}
+
+CityDatabase::CityDatabase() {
+}
+
+CityDatabase::~CityDatabase() {
+    close();
+}
+
+void CityDatabase::close() {
+    if (base) {
+        file.unmap(base);
+        base = nullptr;
+    }
+    file.close();
+    count = 0;
+    xs = ys = nullptr;
+    nameOffsets = nullptr;
+    names = nullptr;
+    nameChars = 0;
+    hashSlots = nullptr;
+    mask = 0;
+    gridCells = gridIds = nullptr;
+    gridCols = gridRows = 0;
+}
+
+// 只做 O(1) 的检查: 文件头、各区的对齐、边界和字节数, 不逐项扫描
+bool CityDatabase::open(const QString &filename, QString *error) {
+    close();
+    file.setFileName(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(error, QString("无法打开文件: %1").arg(file.errorString()));
+    }
+    qint64 fileSize = file.size();
+    if (fileSize < static_cast<qint64>(sizeof(Header))) {
+        file.close();
+        return fail(error, "文件太小, 不是城市数据库");
+    }
+    uchar *data = file.map(0, fileSize);
+    if (!data) {
+        file.close();
+        return fail(error, QString("无法映射文件: %1").arg(file.errorString()));
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    QString problem;
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        problem = "不是城市数据库文件";
+    } else if (header.byteOrder != ENDIAN_MARK) {
+        problem = "文件的字节序与本机不符";
+    } else if (header.version != VERSION) {
+        problem = QString("不支持的数据库版本 %1(当前为 %2)").arg(header.version).arg(VERSION);
+    } else if (header.fileSize != static_cast<quint64>(fileSize)) {
+        problem = "文件长度与文件头不符, 文件可能不完整";
+    } else if (header.cityCount > static_cast<quint64>(std::numeric_limits<int>::max())
+               || header.nameChars > header.fileSize
+               || header.hashCapacity == 0 || (header.hashCapacity & (header.hashCapacity - 1)) != 0
+               || header.hashCapacity <= header.cityCount
+               || (header.cityCount > 0 && (header.gridCols == 0 || header.gridRows == 0))
+               || static_cast<quint64>(header.gridCols) * header.gridRows >= 0xffffffffULL
+               || !(header.gridCellSize > 0)) {
+        problem = "文件头数据无效";
+    } else {
+        quint64 n = header.cityCount;
+        quint64 expected[SECTION_COUNT] = {
+            n * sizeof(double), n * sizeof(double), (n + 1) * sizeof(quint64), header.nameChars * sizeof(QChar),
+            quint64(header.hashCapacity) * sizeof(Slot),
+            (quint64(header.gridCols) * header.gridRows + 1) * sizeof(quint32), n * sizeof(quint32)};
+        for (int s = 0; s < SECTION_COUNT && problem.isEmpty(); ++s) {
+            const SectionInfo &section = header.sections[s];
+            if (section.bytes != expected[s] || section.offset % 8 != 0 || section.offset < sizeof(Header)
+                || section.offset > header.fileSize || section.bytes > header.fileSize - section.offset) {
+                problem = QString("第 %1 区的位置或长度无效").arg(s);
+            }
+        }
+    }
+    if (problem.isEmpty()) {
+        const quint64 *offsets = reinterpret_cast<const quint64 *>(data + header.sections[NameOffsets].offset);
+        if (offsets[header.cityCount] != header.nameChars) problem = "名称区长度不符";
+    }
+    if (!problem.isEmpty()) {
+        file.unmap(data);
+        file.close();
+        return fail(error, problem);
+    }
+
+    base = data;
+    count = static_cast<int>(header.cityCount);
+    xs = reinterpret_cast<const double *>(base + header.sections[Xs].offset);
+    ys = reinterpret_cast<const double *>(base + header.sections[Ys].offset);
+    nameOffsets = reinterpret_cast<const quint64 *>(base + header.sections[NameOffsets].offset);
+    names = reinterpret_cast<const QChar *>(base + header.sections[Names].offset);
+    nameChars = header.nameChars;
+    hashSlots = reinterpret_cast<const Slot *>(base + header.sections[HashSlots].offset);
+    mask = header.hashCapacity - 1;
+    gridCells = reinterpret_cast<const quint32 *>(base + header.sections[GridCells].offset);
+    gridIds = reinterpret_cast<const quint32 *>(base + header.sections[GridIds].offset);
+    gridCols = static_cast<int>(header.gridCols);
+    gridRows = static_cast<int>(header.gridRows);
+    gridMinX = header.gridMinX;
+    gridMinY = header.gridMinY;
+    gridCellSize = header.gridCellSize;
+    return true;
+}
+
+// 偏移不合法(文件损坏)时返回空名称
+QStringView CityDatabase::name(int id) const {
+    quint64 begin = nameOffsets[id], end = nameOffsets[id + 1];
+    if (begin > end || end > nameChars) return QStringView();
+    return QStringView(names + begin, static_cast<qsizetype>(end - begin));
+}
+
+// 线性探测, 先比较哈希值, 相同才比较名称; 表中至少有一个空槽, 探测一定会结束
+int CityDatabase::find(QStringView key) const {
+    if (!base) return -1;
+    quint32 h = hash(key);
+    for (quint32 index = h & mask, probes = 0; probes <= mask; index = (index + 1) & mask, ++probes) {
+        const Slot &slot = hashSlots[index];
+        if (slot.id < 0 || slot.id >= count) return -1;
+        if (slot.hash == h && name(slot.id) == key) return slot.id;
+    }
+    return -1;
+}
+
+bool CityDatabase::write(const QString &filename, const QList<QStringView> &cityNames,
+                         const CityCoordinates &coords, QString *error) {
+    qsizetype n = cityNames.size();
+    if (n != coords.size()) return fail(error, "名称与坐标数量不一致");
+    if (n >= std::numeric_limits<int>::max()) return fail(error, "城市数量过多");
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = ENDIAN_MARK;
+    header.cityCount = n;
+
+    // 名称区
+    std::vector<quint64> offsets(n + 1, 0);
+    for (qsizetype i = 0; i < n; ++i) {
+        offsets[i + 1] = offsets[i] + cityNames[i].size();
+    }
+    header.nameChars = offsets[n];
+    std::vector<QChar> nameData(header.nameChars);
+    for (qsizetype i = 0; i < n; ++i) {
+        std::copy(cityNames[i].begin(), cityNames[i].end(), nameData.begin() + offsets[i]);
+    }
+
+    // 哈希表: 负载因子不超过 0.75, 与 CityManager 相同
+    quint32 capacity = 16;
+    while (n * 4 > static_cast<qint64>(capacity) * 3) capacity *= 2;
+    header.hashCapacity = capacity;
+    std::vector<Slot> table(capacity, Slot{0, -1});
+    for (qsizetype i = 0; i < n; ++i) {
+        quint32 h = hash(cityNames[i]);
+        quint32 index = h & (capacity - 1);
+        while (table[index].id >= 0) {
+            if (table[index].hash == h && cityNames[table[index].id] == cityNames[i]) {
+                return fail(error, QString("城市重名: %1").arg(cityNames[i].toString()));
+            }
+            index = (index + 1) & (capacity - 1);
+        }
+        table[index] = {h, static_cast<qint32>(i)};
+    }
+
+    // 空间网格: 与 SpatialGrid 相同, 平均每格约 2 个城市, 按格子计数排序
+    std::vector<quint32> cells(1, 0), ids(n);
+    header.gridCellSize = 1;
+    if (n > 0) {
+        double x0 = coords.x[0], x1 = x0, y0 = coords.y[0], y1 = y0;
+        for (qsizetype i = 0; i < n; ++i) {
+            x0 = qMin(x0, coords.x[i]);
+            x1 = qMax(x1, coords.x[i]);
+            y0 = qMin(y0, coords.y[i]);
+            y1 = qMax(y1, coords.y[i]);
+        }
+        double width = qMax(x1 - x0, 1e-9), height = qMax(y1 - y0, 1e-9);
+        double cellCount = qMax(1.0, n / 2.0);
+        double cellSize = qMax(std::sqrt(width * height / cellCount), qMax(width, height) / cellCount);
+        int cols = static_cast<int>(width / cellSize) + 1;
+        int rows = static_cast<int>(height / cellSize) + 1;
+        header.gridCols = cols;
+        header.gridRows = rows;
+        header.gridMinX = x0;
+        header.gridMinY = y0;
+        header.gridCellSize = cellSize;
+
+        std::vector<quint32> cellOf(n);
+        cells.assign(static_cast<size_t>(cols) * rows + 1, 0);
+        for (qsizetype i = 0; i < n; ++i) {
+            int cx = cellIndex(coords.x[i], x0, cellSize, cols);
+            int cy = cellIndex(coords.y[i], y0, cellSize, rows);
+            cellOf[i] = cy * cols + cx;
+            cells[cellOf[i] + 1]++;
+        }
+        for (size_t c = 1; c < cells.size(); ++c) cells[c] += cells[c - 1];
+        std::vector<quint32> fill(cells.begin(), cells.end() - 1);
+        for (qsizetype i = 0; i < n; ++i) ids[fill[cellOf[i]]++] = static_cast<quint32>(i);
+    }
+
+    // 按顺序排布各区
+    const void *sectionData[SECTION_COUNT] = {coords.x.data(), coords.y.data(), offsets.data(), nameData.data(),
+                                              table.data(), cells.data(), ids.data()};
+    quint64 sectionBytes[SECTION_COUNT] = {
+        n * sizeof(double), n * sizeof(double), offsets.size() * sizeof(quint64), nameData.size() * sizeof(QChar),
+        table.size() * sizeof(Slot), cells.size() * sizeof(quint32), ids.size() * sizeof(quint32)};
+    quint64 position = align8(sizeof(Header));
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        header.sections[s] = {position, sectionBytes[s]};
+        position = align8(position + sectionBytes[s]);
+    }
+    header.fileSize = position;
+
+    QSaveFile out(filename);
+    if (!out.open(QIODevice::WriteOnly)) {
+        return fail(error, QString("无法写入文件: %1").arg(out.errorString()));
+    }
+    static const char padding[8] = {};
+    bool ok = out.write(reinterpret_cast<const char *>(&header), sizeof(Header)) == sizeof(Header);
+    quint64 written = sizeof(Header);
+    for (int s = 0; s < SECTION_COUNT && ok; ++s) {
+        qint64 gap = static_cast<qint64>(header.sections[s].offset - written);
+        ok = out.write(padding, gap) == gap
+             && out.write(static_cast<const char *>(sectionData[s]), sectionBytes[s])
+                    == static_cast<qint64>(sectionBytes[s]);
+        written = header.sections[s].offset + sectionBytes[s];
+    }
+    qint64 tail = static_cast<qint64>(header.fileSize - written);
+    ok = ok && out.write(padding, tail) == tail;
+    if (!ok || !out.commit()) {
+        return fail(error, QString("写入文件失败: %1").arg(out.errorString()));
+    }
+    return true;
+}
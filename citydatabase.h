@@ -0,0 +1,151 @@
+#ifndef CITYDATABASE_H
+#define CITYDATABASE_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <cmath>
+#include "distancematrix.h"
+
+// 城市数据库文件(.tspdb): 只读映射, 打开即可查询, 不做解析也不复制
+// 文件布局(小端, 各区按 8 字节对齐):
+//   Header                 魔数、版本、城市数, 以及下面各区的偏移和字节数
+//   x[n], y[n]             double 坐标数组(SoA), 可直接作为求解器的坐标
+//   nameOffsets[n+1]       quint64, 第 i 个名称在名称区中的 [nameOffsets[i], nameOffsets[i+1])
+//   names                  全部名称的 UTF-16 字符依次相连
+//   hashSlots[capacity]    开放定址(线性探测)哈希表, {哈希值, 编号}, 编号 -1 为空槽; 哈希函数同 CityManager
+//   gridCells[cells+1]     均匀网格(平均每格约 2 个城市)每格在 gridIds 中的起始位置, 多一个结尾
+//   gridIds[n]             按格子顺序排列的城市编号
+// 打开时只检查文件头和各区的边界, 与城市数无关; 格式变化时增加 VERSION, 旧版本文件拒绝打开
+class CityDatabase {
+public:
+    static const quint32 VERSION = 1;
+
+    CityDatabase();
+    ~CityDatabase();
+
+    CityDatabase(const CityDatabase &) = delete;
+    CityDatabase &operator=(const CityDatabase &) = delete;
+
+    // 映射并检查文件, 失败时返回 false 并在 error 中说明原因
+    bool open(const QString &filename, QString *error = nullptr);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    // 打开的文件名, 未打开时为空
+    QString fileName() const { return isOpen() ? file.fileName() : QString(); }
+
+    // 按编号顺序写出一组城市, 名称不能重复; 先写临时文件, 成功后再替换
+    static bool write(const QString &filename, const QList<QStringView> &names, const CityCoordinates &coords,
+                      QString *error = nullptr);
+
+    // 城市名称的哈希: 对 UTF-16 编码逐个做 FNV-1a, 最后用 murmur3 的 finalizer 打散高低位
+    // 哈希值写在文件里, 修改它必须同时增加 VERSION
+    static quint32 hash(QStringView name) {
+        quint64 h = 14695981039346656037ULL;
+        for (qsizetype i = 0; i < name.size(); ++i) {
+            h ^= name[i].unicode();
+            h *= 1099511628211ULL;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<quint32>(h);
+    }
+
+    int size() const { return count; }
+    double x(int id) const { return xs[id]; }
+    double y(int id) const { return ys[id]; }
+    QStringView name(int id) const;
+
+    // 坐标数组, 城市编号即下标
+    const double *xData() const { return xs; }
+    const double *yData() const { return ys; }
+
+    // 按名称查找城市编号, 不存在返回 -1
+    int find(QStringView name) const;
+
+    // 遍历与 (cx, cy) 距离不超过 range 的所有城市, func(id)
+    template <typename Func>
+    void forEachWithin(double cx, double cy, double range, Func func) const;
+
+private:
+    enum Section { Xs, Ys, NameOffsets, Names, HashSlots, GridCells, GridIds, SECTION_COUNT };
+
+    struct SectionInfo {
+        quint64 offset;
+        quint64 bytes;
+    };
+
+    struct Header {
+        char magic[8];          // "TSPCITY\0"
+        quint32 version;
+        quint32 byteOrder;      // 写入 0x01020304, 读出不同说明字节序不符
+        quint64 fileSize;
+        quint64 cityCount;
+        quint64 nameChars;      // 名称区的 UTF-16 字符数
+        quint32 hashCapacity;   // 哈希表容量, 2 的幂
+        quint32 gridCols;
+        quint32 gridRows;
+        quint32 reserved;
+        double gridMinX;        // 网格左下角
+        double gridMinY;
+        double gridCellSize;    // 格子边长
+        SectionInfo sections[SECTION_COUNT];
+    };
+
+    struct Slot {
+        quint32 hash;
+        qint32 id;
+    };
+
+    QFile file;
+    uchar *base = nullptr;
+    int count = 0;
+    const double *xs = nullptr;
+    const double *ys = nullptr;
+    const quint64 *nameOffsets = nullptr;
+    const QChar *names = nullptr;
+    quint64 nameChars = 0;
+    const Slot *hashSlots = nullptr;
+    quint32 mask = 0;
+    const quint32 *gridCells = nullptr;
+    const quint32 *gridIds = nullptr;
+    int gridCols = 0, gridRows = 0;
+    double gridMinX = 0, gridMinY = 0, gridCellSize = 1;
+
+    // 先在 double 上截断到网格范围再转成 int, 很大或无穷大的查询半径不会让转换溢出
+    static int cellIndex(double v, double origin, double cellSize, int cells) {
+        return static_cast<int>(qBound(0.0, std::floor((v - origin) / cellSize), cells - 1.0));
+    }
+    int cellX(double v) const { return cellIndex(v, gridMinX, gridCellSize, gridCols); }
+    int cellY(double v) const { return cellIndex(v, gridMinY, gridCellSize, gridRows); }
+};
+
+// 只检查与查询圆外接正方形相交的格子, 用平方距离比较;
+// 索引内容在打开时没有逐项检查, 这里跳过越界的编号, 损坏的文件只会查不到城市而不会越界访问
+template <typename Func>
+void CityDatabase::forEachWithin(double cx, double cy, double range, Func func) const {
+    if (count == 0 || !(range >= 0)) return; // 负数和 NaN 查不到任何城市
+
+    double range2 = range * range;
+    int x0 = cellX(cx - range), x1 = cellX(cx + range);
+    int y0 = cellY(cy - range), y1 = cellY(cy + range);
+    for (int gy = y0; gy <= y1; ++gy) {
+        for (int gx = x0; gx <= x1; ++gx) {
+            int cell = gy * gridCols + gx;
+            quint32 end = qMin<quint32>(gridCells[cell + 1], count);
+            for (quint32 k = gridCells[cell]; k < end; ++k) {
+                quint32 id = gridIds[k];
+                if (id >= static_cast<quint32>(count)) continue;
+                double dx = xs[id] - cx, dy = ys[id] - cy;
+                if (dx * dx + dy * dy <= range2) func(static_cast<int>(id));
+            }
+        }
+    }
+}
+
+#endif // CITYDATABASE_H
@@ -0,0 +1,165 @@
+#include "cityfileparser.h"
+#include <QFile>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include "threadpool.h"
+
+namespace {
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// 把 [begin, end) 整体转换为有限的 double, 允许前导 '+'
+bool parseNumber(const char *begin, const char *end, double &value) {
+    if (begin < end && *begin == '+') ++begin;
+    if (begin == end) return false;
+    std::from_chars_result result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end && std::isfinite(value);
+}
+}
+
+QString CityFileReport::kindName(CityFileIssue::Kind kind) {
+    switch (kind) {
+    case CityFileIssue::MissingFields: return "字段不足";
+    case CityFileIssue::InvalidNumber: return "坐标无效";
+    case CityFileIssue::DuplicateName: return "城市重名";
+    }
+    return QString();
+}
+
+CityFileParser::CityFileParser(int threadCount)
+    : threads(threadCount > 0 ? threadCount : WorkStealingPool::idealThreadCount()) {
+}
+
+qint64 CityFileParser::lineCount() const {
+    qint64 total = 0;
+    for (const Chunk &chunk : parts) total += chunk.lineCount;
+    return total;
+}
+
+qint64 CityFileParser::entryCount() const {
+    qint64 total = 0;
+    for (const Chunk &chunk : parts) total += static_cast<qint64>(chunk.entries.size());
+    return total;
+}
+
+// 映射整个文件, 解析完立即解除映射; 结果中不引用文件内容
+bool CityFileParser::parseFile(const QString &filename) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    qint64 size = file.size();
+    if (size == 0) {
+        parse(nullptr, 0);
+        return true;
+    }
+    uchar *data = file.map(0, size);
+    if (data) {
+        parse(reinterpret_cast<const char *>(data), size);
+        file.unmap(data);
+    } else {
+        // 不支持映射的设备(如管道)退回到一次性读入
+        QByteArray bytes = file.readAll();
+        parse(bytes.constData(), bytes.size());
+    }
+    return true;
+}
+
+// 按字节数均分, 每个切点推到下一个换行符之后, 各块都从行首开始
+void CityFileParser::parse(const char *data, qint64 size) {
+    parts.clear();
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        data += 3; // UTF-8 BOM
+        size -= 3;
+    }
+
+    int chunkCount = static_cast<int>(qBound<qint64>(1, size / MIN_CHUNK_BYTES, threads * 4));
+    std::vector<const char *> bounds;
+    bounds.push_back(data);
+    for (int i = 1; i < chunkCount; ++i) {
+        const char *cut = qMax(bounds.back(), data + size * i / chunkCount);
+        const char *newline = static_cast<const char *>(std::memchr(cut, '\n', data + size - cut));
+        if (!newline) break;
+        bounds.push_back(newline + 1);
+    }
+    bounds.push_back(data + size);
+    parts.resize(bounds.size() - 1);
+
+    if (parts.size() == 1) {
+        parseChunk(bounds[0], bounds[1], parts[0]);
+    } else {
+        WorkStealingPool pool(qMin(threads, static_cast<int>(parts.size())));
+        pool.run(static_cast<int>(parts.size()), [&](int index, int) {
+            parseChunk(bounds[index], bounds[index + 1], parts[index]);
+        });
+    }
+
+    // 各块的行数求前缀和, 得到全局行号
+    qint64 line = 1;
+    for (Chunk &chunk : parts) {
+        chunk.firstLine = line;
+        for (CityFileIssue &issue : chunk.issues) issue.line += line;
+        line += chunk.lineCount;
+    }
+}
+
+void CityFileParser::parseChunk(const char *begin, const char *end, Chunk &chunk) {
+    chunk.entries.reserve((end - begin) / 24);
+    qint64 line = 0;
+
+    for (const char *p = begin; p < end; ++line) {
+        const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!lineEnd) lineEnd = end;
+        const char *lineStart = p;
+        p = lineEnd + 1;
+
+        // 依次取出前三个字段
+        const char *fields[3][2];
+        int fieldCount = 0;
+        const char *q = lineStart;
+        while (fieldCount < 3) {
+            while (q < lineEnd && isBlank(*q)) ++q;
+            if (q == lineEnd) break;
+            fields[fieldCount][0] = q;
+            while (q < lineEnd && !isBlank(*q)) ++q;
+            fields[fieldCount][1] = q;
+            fieldCount++;
+        }
+        if (fieldCount == 0) continue; // 空行
+
+        CityFileIssue::Kind kind = CityFileIssue::MissingFields;
+        double x = 0, y = 0;
+        bool valid = fieldCount == 3;
+        if (valid) {
+            kind = CityFileIssue::InvalidNumber;
+            valid = parseNumber(fields[1][0], fields[1][1], x) && parseNumber(fields[2][0], fields[2][1], y);
+        }
+        if (!valid) {
+            chunk.issueCounts[kind]++;
+            if (chunk.issues.size() < static_cast<size_t>(CityFileReport::MAX_ISSUES)) {
+                const char *textEnd = lineEnd > lineStart && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+                int textLength = static_cast<int>(qMin<qint64>(textEnd - lineStart, MAX_LINE_TEXT));
+                chunk.issues.push_back({line, kind, QString::fromUtf8(lineStart, textLength)});
+            }
+            continue;
+        }
+
+        // 名称解码: 纯 ASCII 时逐字节扩展, 否则按 UTF-8 解码
+        const char *name = fields[0][0];
+        int nameLength = static_cast<int>(fields[0][1] - name);
+        int offset = static_cast<int>(chunk.names.size());
+        bool ascii = true;
+        for (int i = 0; i < nameLength && ascii; ++i) ascii = static_cast<uchar>(name[i]) < 0x80;
+        if (ascii) {
+            chunk.names.resize(offset + nameLength);
+            QChar *out = chunk.names.data() + offset;
+            for (int i = 0; i < nameLength; ++i) out[i] = QLatin1Char(name[i]);
+        } else {
+            chunk.names += QString::fromUtf8(name, nameLength);
+        }
+        chunk.entries.push_back({offset, static_cast<int>(chunk.names.size()) - offset, x, y, line});
+    }
+    chunk.lineCount = line;
+}
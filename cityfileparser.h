@@ -0,0 +1,83 @@
+#ifndef CITYFILEPARSER_H
+#define CITYFILEPARSER_H
+
+#include <QList>
+#include <QString>
+#include <vector>
+
+// 城市文件中有问题的一行
+struct CityFileIssue {
+    enum Kind {
+        MissingFields,  // 不足"名称 x y"三个字段
+        InvalidNumber,  // 坐标不是有限的数字
+        DuplicateName   // 与前面的城市重名, 保留先出现的
+    };
+    qint64 line;  // 行号, 从 1 开始
+    Kind kind;
+    QString text; // 该行内容(过长时截断)
+};
+
+// 城市文件的加载报告
+struct CityFileReport {
+    static const int MAX_ISSUES = 1000; // 最多保留多少条问题明细, 计数不受限制
+
+    qint64 lineCount = 0;          // 总行数
+    int cityCount = 0;             // 加载的城市数
+    qint64 issueCounts[3] = {};    // 按 CityFileIssue::Kind 统计的问题行数
+    QList<CityFileIssue> issues;   // 按行号排列的前 MAX_ISSUES 条问题
+    qint64 elapsedMs = 0;          // 用时(毫秒)
+
+    qint64 issueCount() const { return issueCounts[0] + issueCounts[1] + issueCounts[2]; }
+
+    // 问题类型的中文说明
+    static QString kindName(CityFileIssue::Kind kind);
+};
+
+// 城市文件解析器, 每行 "名称 x y", 字段以空白分隔, 多余的字段忽略, 空行跳过
+// 文件整体映射到内存, 按行边界切成若干块在线程池上并行解析, 数字用 std::from_chars 转换,
+// 名称(UTF-8)解码后连续存放在每块自己的字符串里, 不为每个城市单独分配
+class CityFileParser {
+public:
+    // 一个解析出的城市, 名称是所在块 names 中的 [nameOffset, nameOffset + nameLength)
+    struct Entry {
+        int nameOffset;
+        int nameLength;
+        double x;
+        double y;
+        qint64 line; // 块内行号, 从 0 开始
+    };
+
+    // 一块的解析结果
+    struct Chunk {
+        qint64 firstLine = 1;      // 第一行的全局行号
+        qint64 lineCount = 0;
+        QString names;
+        std::vector<Entry> entries;
+        std::vector<CityFileIssue> issues; // 本块的格式问题, 最多 MAX_ISSUES 条, 行号已是全局行号
+        qint64 issueCounts[2] = {};        // 本块 MissingFields, InvalidNumber 的行数
+    };
+
+    // threadCount <= 0 时使用 CPU 核心数
+    explicit CityFileParser(int threadCount = 0);
+
+    // 映射并解析文件, 文件无法打开时返回 false
+    bool parseFile(const QString &filename);
+
+    // 解析一段内存中的文本
+    void parse(const char *data, qint64 size);
+
+    const std::vector<Chunk> &chunks() const { return parts; }
+    qint64 lineCount() const;
+    qint64 entryCount() const;
+
+private:
+    static const qint64 MIN_CHUNK_BYTES = 1 << 20; // 每块至少 1MB, 小文件不开线程
+    static const int MAX_LINE_TEXT = 100;          // 问题明细中保留的行内容字节数
+
+    int threads;
+    std::vector<Chunk> parts;
+
+    static void parseChunk(const char *begin, const char *end, Chunk &chunk);
+};
+
+#endif // CITYFILEPARSER_H
@@ -0,0 +1,141 @@
+#include "citylayeritem.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <cmath>
+
+namespace {
+
+const double POINT_RADIUS = 5;       // 放大时城市圆点的半径(像素)
+const double POINT_PIXELS = 3;       // 成批绘制时城市点的边长(像素), 也是抽稀的像素块大小
+const int DETAIL_LIMIT = 2000;       // 可见城市不超过这个数时画带轮廓的圆点
+const int LABEL_LIMIT = 300;         // 可见城市不超过这个数时画城市名, 再多标签会互相重叠
+const int DEDUPE_LIMIT = 20000;      // 可见城市超过这个数时按像素块去重
+const double LABEL_MARGIN = 120;     // 画城市名时视口向外扩展的像素, 视口外城市的标签也可能露出来
+
+} // namespace
+
+CityLayerItem::CityLayerItem(QGraphicsItem *parent) : QGraphicsItem(parent) {
+    // 需要 exposedRect 来裁剪到视口
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    // 按设备坐标缓存: 上面的回路层刷新和平移时不重绘城市, 缩放后才重绘
+    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+}
+
+// 设置城市, 重建抽稀索引
+void CityLayerItem::setCities(const CityCoordinates &points, const QStringList &names) {
+    prepareGeometryChange();
+    pyramid.build(points);
+    this->names = names;
+
+    bounds = QRectF();
+    if (points.size() > 0) {
+        double minX = points.x[0], maxX = points.x[0];
+        double minY = points.y[0], maxY = points.y[0];
+        for (int i = 0; i < points.size(); ++i) {
+            minX = qMin(minX, points.x[i]);
+            maxX = qMax(maxX, points.x[i]);
+            minY = qMin(minY, points.y[i]);
+            maxY = qMax(maxY, points.y[i]);
+        }
+        // 四周留出 10% 给圆点和标签
+        double margin = qMax(qMax(maxX - minX, maxY - minY) * 0.1, 1.0);
+        bounds = QRectF(minX, minY, maxX - minX, maxY - minY).adjusted(-margin, -margin, margin, margin);
+    }
+    update();
+}
+
+void CityLayerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    Q_UNUSED(widget);
+
+    // 每单位场景长度对应的像素数
+    const QTransform toDevice = painter->worldTransform();
+    double pixelsPerUnit = QStyleOptionGraphicsItem::levelOfDetailFromTransform(toDevice);
+    if (pixelsPerUnit <= 0) return;
+
+    drawCities(painter, option->exposedRect, toDevice, pixelsPerUnit);
+}
+
+// 城市点和标签
+void CityLayerItem::drawCities(QPainter *painter, const QRectF &exposed, const QTransform &toDevice, double pixelsPerUnit) {
+    if (pyramid.size() == 0) return;
+
+    // 视口外半个圆点以内的城市也要画
+    double margin = (POINT_RADIUS + 1) / pixelsPerUnit;
+    QRectF area = exposed.adjusted(-margin, -margin, margin, margin);
+
+    int level = pyramid.levelFor(pixelsPerUnit, POINT_PIXELS);
+    visiblePoints.clear();
+    visibleIds.clear();
+    pyramid.forEachIn(level, area.left(), area.top(), area.right(), area.bottom(), [this](int id, double x, double y) {
+        visiblePoints.append(QPointF(x, y));
+        visibleIds.append(id);
+    });
+
+    // 放大到可见城市不多时: 黑色轮廓的红色圆点, 大小按像素计算, 不随缩放变化
+    if (level == 0 && visiblePoints.size() <= DETAIL_LIMIT) {
+        QPen pen(Qt::black);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->setBrush(Qt::red);
+        double radius = POINT_RADIUS / pixelsPerUnit;
+        for (const QPointF &point : visiblePoints) {
+            painter->drawEllipse(point, radius, radius);
+        }
+
+        // 标签放在城市点上方，右侧对齐; 视口外附近的城市的标签也可能露出来, 重新按扩大的范围查询
+        double labelMargin = LABEL_MARGIN / pixelsPerUnit;
+        QRectF labelArea = exposed.adjusted(-labelMargin, -labelMargin, labelMargin, labelMargin);
+        visiblePoints.clear();
+        visibleIds.clear();
+        pyramid.forEachIn(0, labelArea.left(), labelArea.top(), labelArea.right(), labelArea.bottom(), [this](int id, double x, double y) {
+            visiblePoints.append(QPointF(x, y));
+            visibleIds.append(id);
+        });
+        if (visibleIds.size() > LABEL_LIMIT) return;
+
+        // 标签按屏幕像素排版: 先换到设备坐标再写字
+        painter->save();
+        painter->setWorldTransform(QTransform());
+        painter->setPen(Qt::black);
+        QPointF offset(9, -16 + painter->fontMetrics().ascent());
+        for (int i = 0; i < visibleIds.size(); ++i) {
+            painter->drawText(toDevice.map(visiblePoints[i]) + offset, names.value(visibleIds[i]));
+        }
+        painter->restore();
+        return;
+    }
+
+    // 成批绘制: 一次 drawPoints, 关闭抗锯齿
+    if (visiblePoints.size() > DEDUPE_LIMIT) {
+        dedupeByPixel(area, toDevice);
+    }
+    QPen pen(Qt::red);
+    pen.setWidthF(POINT_PIXELS);
+    pen.setCosmetic(true);
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setPen(pen);
+    painter->drawPoints(visiblePoints.constData(), static_cast<int>(visiblePoints.size()));
+    painter->restore();
+}
+
+// 只保留每个像素块中的第一个点
+// 城市密集成团时抽稀索引的格子里仍可能有很多点, 按像素块去重后画出的点数不超过视口的像素块数
+void CityLayerItem::dedupeByPixel(const QRectF &exposed, const QTransform &toDevice) {
+    QRectF device = toDevice.mapRect(exposed);
+    int cols = qMax(1, static_cast<int>(std::ceil(device.width() / POINT_PIXELS)) + 1);
+    int rows = qMax(1, static_cast<int>(std::ceil(device.height() / POINT_PIXELS)) + 1);
+    occupied.assign(static_cast<size_t>(cols) * rows, 0);
+
+    int kept = 0;
+    for (int i = 0; i < visiblePoints.size(); ++i) {
+        QPointF p = toDevice.map(visiblePoints[i]);
+        int gx = qBound(0, static_cast<int>((p.x() - device.left()) / POINT_PIXELS), cols - 1);
+        int gy = qBound(0, static_cast<int>((p.y() - device.top()) / POINT_PIXELS), rows - 1);
+        quint8 &cell = occupied[static_cast<size_t>(gy) * cols + gx];
+        if (cell) continue;
+        cell = 1;
+        visiblePoints[kept++] = visiblePoints[i];
+    }
+    visiblePoints.resize(kept);
+}
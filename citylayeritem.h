@@ -0,0 +1,40 @@
+#ifndef CITYLAYERITEM_H
+#define CITYLAYERITEM_H
+
+#include <QGraphicsItem>
+#include <QStringList>
+#include <vector>
+#include "pointpyramid.h"
+
+// 地图的城市层, 用一个图形项成批绘制全部城市点和标签; 回路由 TourLayerItem 单独绘制
+// 每次绘制只处理与视口相交的部分: 城市点按缩放级别从 PointPyramid 中选一层抽稀,
+// 一个像素块里最多画一个点; 放大到可见城市不多时才画圆点轮廓和城市名.
+// 场景中的图形项个数与城市数无关, 百万个城市时平移和缩放的绘制量也只和视口像素数同级.
+// 绘制结果按设备坐标缓存, 回路变化和平移时直接贴图, 只有城市或缩放变化时才重绘
+class CityLayerItem : public QGraphicsItem {
+public:
+    explicit CityLayerItem(QGraphicsItem *parent = nullptr);
+
+    // 设置城市的场景坐标和名称(下标一一对应), 重建抽稀索引
+    void setCities(const CityCoordinates &points, const QStringList &names);
+
+    QRectF boundingRect() const override { return bounds; }
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    PointPyramid pyramid;
+    QStringList names;
+    QRectF bounds;
+
+    // 绘制时复用的缓冲区
+    QList<QPointF> visiblePoints;
+    QList<int> visibleIds;
+    std::vector<quint8> occupied;
+
+    void drawCities(QPainter *painter, const QRectF &exposed, const QTransform &toDevice, double pixelsPerUnit);
+
+    // 只保留每个像素块中的第一个点
+    void dedupeByPixel(const QRectF &exposed, const QTransform &toDevice);
+};
+
+#endif // CITYLAYERITEM_H
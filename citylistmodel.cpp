@@ -0,0 +1,33 @@
+#include "citylistmodel.h"
+
+CityListModel::CityListModel(QObject *parent) : QAbstractTableModel(parent) {
+}
+
+void CityListModel::setCities(const QList<City> &cities) {
+    beginResetModel();
+    this->cities = cities;
+    endResetModel();
+}
+
+int CityListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(cities.size());
+}
+
+int CityListModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : 2;
+}
+
+// 名称列同时作为编辑角色, 可编辑的下拉框和补全按它匹配输入
+QVariant CityListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= cities.size()) return QVariant();
+    const City &city = cities[index.row()];
+
+    if (index.column() == NameColumn && (role == Qt::DisplayRole || role == Qt::EditRole)) {
+        return city.name;
+    }
+    if (index.column() == DetailColumn && role == Qt::DisplayRole) {
+        // 格式如"城市名 x:100 y:200"
+        return QString("%1 x:%2 y:%3").arg(city.name).arg(city.x).arg(city.y);
+    }
+    return QVariant();
+}
@@ -0,0 +1,32 @@
+#ifndef CITYLISTMODEL_H
+#define CITYLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include "citymanager.h"
+
+// 城市下拉框、补全和城市列表共用的数据模型
+// 第 0 列是城市名, 第 1 列是城市列表显示的"城市名 x:.. y:..";
+// 视图只为可见的行取数据, 百万个城市时刷新也只是替换一份列表, 不逐个创建控件项
+class CityListModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        NameColumn,
+        DetailColumn
+    };
+
+    explicit CityListModel(QObject *parent = nullptr);
+
+    // 替换全部城市, 使用该模型的视图随之重置
+    void setCities(const QList<City> &cities);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    QList<City> cities;
+};
+
+#endif // CITYLISTMODEL_H
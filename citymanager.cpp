@@ -1,94 +1,190 @@
 #include "citymanager.h"
 #include <iostream>
-#include "qregularexpression.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QLocale>
 #include <QTextStream>
 #include <algorithm>
-#include <QRegularExpression>
 #include <random>
+#include <QtAlgorithms>
+#include <limits>
+#include <vector>
+#include <atomic>
+#include "threadpool.h"
+#include "antcolony.h"
+#include "branchandbound.h"
+#include "christofides.h"
+#include "localsearch.h"
+#include "linkernighan.h"
+#include <QElapsedTimer>
 
 CityManager::CityManager() {
+    rehash(MIN_CAPACITY);
+    std::random_device device;
+    randomSeed = (static_cast<quint64>(device()) << 32) | device();
 }
 
 CityManager::~CityManager() {
+    // 内存池析构时释放全部 slab
 }
 
-// 添加城市
-bool CityManager::addCity(const City& city) {
-    int index = CityManager::hash(city.name);
+// 线性探测查找城市所在槽位
+int CityManager::findSlot(QStringView name, quint32 h) const {
+    int index = h & mask;
+    const Slot *slotData = hashSlots.constData();
+    while (slotData[index].id >= 0) {
+        if (slotData[index].hash == h && nameOf(slotData[index].id) == name) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    return -1;
+}
 
-    // 检查是否有同名城市
-    for (Node *node = list[index]; node; node = node->next) {
-        if (node->city.name == city.name) {
-            std::cout << "城市已存在!无法重复添加。" << std::endl;
-            return false; // 同名城市不添加
+// 扩容: 新建一张更大的表, 把旧槽位按保存的哈希值重新放入
+void CityManager::rehash(int newCapacity) {
+    QList<Slot> oldSlots = std::move(hashSlots);
+    hashSlots = QList<Slot>(newCapacity);
+    mask = newCapacity - 1;
+
+    for (const Slot &slot : oldSlots) {
+        if (slot.id < 0) continue;
+        int index = slot.hash & mask;
+        while (hashSlots[index].id >= 0) {
+            index = (index + 1) & mask;
+        }
+        hashSlots[index] = slot;
+    }
+}
+
+// 清空所有城市: 内存池 O(1) 复位, 哈希表只把槽位置空, 都不归还内存
+void CityManager::clearAll() {
+    database.reset();
+    pool.reset();
+    grid.clear();
+    hashSlots.fill(Slot());
+    size = 0;
+}
+
+// 数据库转为内存中的城市: 按编号顺序插入, 编号与 getAllCities() 的顺序保持一致
+void CityManager::detachDatabase() {
+    if (!database) return;
+    std::unique_ptr<CityDatabase> source = std::move(database);
+    clearAll();
+    reserve(source->size());
+    QList<SpatialGrid::Entry> points;
+    points.reserve(source->size());
+    for (int i = 0; i < source->size(); ++i) {
+        int id = insertRecord(source->name(i), source->x(i), source->y(i));
+        if (id >= 0) {
+            points.append({source->x(i), source->y(i), id});
         }
     }
+    grid.build(points);
+}
 
-    // 创建新节点
-    Node *newNode = new Node(city);
+// 比较规范路径, 同一文件的不同写法(相对路径、符号链接)也能识别; 目标文件不存在时规范路径为空
+bool CityManager::detachIfMapped(const QString& filename) {
+    if (!database) return false;
+    QString target = QFileInfo(filename).canonicalFilePath();
+    if (target.isEmpty() || target != QFileInfo(database->fileName()).canonicalFilePath()) return false;
+    detachDatabase();
+    return true;
+}
 
-    if (!list[index]) {
-        // 链表为空，直接插入
-        list[index] = newNode;
-        size++; // 城市数量+1
-        return true;
-    } else {
-        // 尾插法
-        // Node *current = list[index];
-        // while (current->next) {
-        //     current = current->next;
-        // }
-        // current->next = newNode; // 将新节点连接到尾部
+// 把城市记录放入内存池和哈希表
+int CityManager::insertRecord(QStringView name, double x, double y) {
+    quint32 h = hash(name);
 
-        // 头插法,提高效率
-        newNode->next = list[index]; // 新节点指向旧的头节点
-        list[index] = newNode; // 更新头指针
-        size++; // 城市数量+1
-        return 1;
+    // 检查是否有同名城市
+    if (findSlot(name, h) >= 0) {
+        return -1; // 同名城市不添加
+    }
+
+    // 负载因子超过 0.75 时容量翻倍, 保证探测序列足够短
+    if ((size + 1) * 4 > (mask + 1) * 3) {
+        rehash((mask + 1) * 2);
+    }
+
+    // 从哈希位置开始找第一个空槽
+    int index = h & mask;
+    while (hashSlots[index].id >= 0) {
+        index = (index + 1) & mask;
+    }
+    hashSlots[index].hash = h;
+    hashSlots[index].id = pool.allocate(name, x, y);
+    size++; // 城市数量+1
+    return hashSlots[index].id;
+}
+
+// 预留哈希表容量, 使 count 个城市的负载因子不超过 0.75
+void CityManager::reserve(int count) {
+    int capacity = mask + 1;
+    while (count * 4LL > capacity * 3LL) {
+        capacity *= 2;
     }
+    if (capacity > mask + 1) {
+        rehash(capacity);
+    }
+}
+
+// 添加城市, 同名城市已存在时返回 false
+bool CityManager::addCity(const City& city) {
+    detachDatabase();
+    int id = insertRecord(city.name, city.x, city.y);
+    if (id < 0) {
+        return false;
+    }
+    grid.insert(id, city.x, city.y);
+    return true;
 }
 
 
 // 删除城市
 bool CityManager::removeCity(const QString& name) {
-    int index = hash(name);
-    Node *current = list[index];
-    Node *prev = nullptr;
-
-    // 遍历哈希链表查找目标节点
-    while (current != nullptr) {
-        if (current->city.name == name) {
-            // 找到目标节点，执行删除
-            if (prev == nullptr) {
-                // 删除头节点
-                list[index] = current->next;
-            } else {
-                // 删除中间或尾节点：更新前一个节点的next指针
-                prev->next = current->next;
-            }
-            delete current; // 释放内存
-            return 1;
-        }
-        // 移动指针
-        prev = current;
-        current = current->next;
+    detachDatabase();
+    int index = findSlot(name, hash(name));
+    if (index < 0) {
+        // 未找到城市
+        std::cout << "城市不存在!" << std::endl;
+        return false;
     }
 
-    // 未找到城市
-    std::cout << "城市不存在!" << std::endl;
-    return 0;
+    const CityPool::Record &record = pool.at(hashSlots[index].id);
+    grid.remove(hashSlots[index].id, record.x, record.y);
+    pool.release(hashSlots[index].id); // 记录归还内存池
+    hashSlots[index] = Slot();
+    size--; // 城市数量-1
+
+    // 向后移位删除: 把后面同一探测序列上的元素前移填补空位, 不需要墓碑标记
+    int hole = index;
+    int next = (index + 1) & mask;
+    while (hashSlots[next].id >= 0) {
+        int home = hashSlots[next].hash & mask;
+        // home 不在 (hole, next] 区间内时, 该元素可以移动到空位上
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            hashSlots[hole] = hashSlots[next];
+            hashSlots[next] = Slot();
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    return true;
 }
 
 // 按名字查找城市
 City CityManager::findCity(const QString& name) const {
-    City result;
-    int index = hash(name);
-    for (const Node *node = list[index]; node; node = node->next) {
-        if (node->city.name == name) {
-            result = node->city;
-            return result;
+    if (database) {
+        int id = database->find(name);
+        if (id >= 0) {
+            return {database->name(id).toString(), database->x(id), database->y(id)};
         }
+        std::cout << "城市不存在!" << std::endl;
+        return {"", 0, 0};
+    }
+    int index = findSlot(name, hash(name));
+    if (index >= 0) {
+        return cityAt(hashSlots[index].id);
     }
     std::cout << "城市不存在!" << std::endl;
     return {"", 0, 0}; // 返回空城市
@@ -97,7 +193,9 @@ City CityManager::findCity(const QString& name) const {
 
 // 城市距离
 double CityManager::distance(const City& a, const City& b) const {
-    return std::sqrt(std::pow(a.x - b.x, 2) + std::pow(a.y - b.y, 2));
+    double dx = a.x - b.x;
+    double dy = a.y - b.y;
+    return std::sqrt(dx * dx + dy * dy);
 }
 
 // 城市数量
@@ -105,41 +203,96 @@ int CityManager::getCityCount() const {
     return size;
 }
 
+// 内存池分配统计
+const CityPool::Stats &CityManager::getPoolStats() const {
+    return pool.stats();
+}
+
 // 获取所有城市
 QList<City> CityManager::getAllCities() const {
     QList<City> allCities;
-    for (int i = 0; i < HASH_SIZE; ++i) {
-        Node *current = list[i];
-        while (current) {
-            allCities.append(current->city);
-            current = current->next;
+    allCities.reserve(size);
+    if (database) {
+        for (int id = 0; id < database->size(); ++id) {
+            allCities.append({database->name(id).toString(), database->x(id), database->y(id)});
+        }
+        return allCities;
+    }
+    // 按内存池中的记录顺序(即插入顺序)输出
+    for (int id = 0; id < pool.capacity(); ++id) {
+        if (pool.at(id).name) {
+            allCities.append(cityAt(id));
         }
     }
     return allCities;
 }
 
+// 获取所有城市的坐标
+CityCoordinates CityManager::getCoordinates() const {
+    CityCoordinates coords;
+    if (database) {
+        // 坐标在文件中就是 SoA 数组, 整块复制
+        coords.x.assign(database->xData(), database->xData() + database->size());
+        coords.y.assign(database->yData(), database->yData() + database->size());
+        return coords;
+    }
+    coords.x.reserve(size);
+    coords.y.reserve(size);
+    for (int id = 0; id < pool.capacity(); ++id) {
+        const CityPool::Record &record = pool.at(id);
+        if (record.name) {
+            coords.append(record.x, record.y);
+        }
+    }
+    return coords;
+}
+
 // 获取某城市一定范围内所有城市
 QList<City> CityManager::getCitiesWithinRange(const QString& targetCityName, double range) const {
     QList<City> result;
 
-    City target = findCity(targetCityName);
-    if (target.name.isEmpty()) {
+    if (database) {
+        int targetId = database->find(targetCityName);
+        if (targetId < 0) {
+            std::cout << "城市不存在!" << std::endl;
+            return result;
+        }
+        database->forEachWithin(database->x(targetId), database->y(targetId), range, [&](int id) {
+            if (id != targetId) {
+                result.append({database->name(id).toString(), database->x(id), database->y(id)});
+            }
+        });
         return result;
     }
 
-    QList<City> allCities = getAllCities();
-    Q_FOREACH(const auto& city, allCities) {
-        if (city.name == target.name) continue;
+    int index = findSlot(targetCityName, hash(targetCityName));
+    if (index < 0) {
+        std::cout << "城市不存在!" << std::endl;
+        return result;
+    }
 
-        double dist = distance(target, city);
-        if (dist <= range) {
-            result.append(city);
+    // 通过空间网格只检查查询圆附近的格子
+    int targetId = hashSlots[index].id;
+    const CityPool::Record &target = pool.at(targetId);
+    grid.forEachWithin(target.x, target.y, range, [&](const SpatialGrid::Entry &entry) {
+        if (entry.id != targetId) {
+            result.append(cityAt(entry.id));
         }
-    }
+    });
 
     return result;
 }
 
+// 设置求解控制块
+void CityManager::setSolverControl(SolverControl* control) {
+    solverControl = control;
+}
+
+// 获取求解控制块
+SolverControl* CityManager::getSolverControl() const {
+    return solverControl;
+}
+
 
 // 根据索引列表构建路径
 QList<City> CityManager::buildPathFromIndices(const QList<City>& cityList, const QList<int>& indices) const {
@@ -154,24 +307,36 @@ QList<City> CityManager::buildPathFromIndices(const QList<City>& cityList, const
     return path;
 }
 
-// 计算阶乘
+// 计算阶乘, n >= 21 时超出 long long, 饱和为 LLONG_MAX
 long long CityManager::factorial(int n) const {
     long long result = 1;
     for (int i = 2; i <= n; ++i) {
+        if (result > std::numeric_limits<long long>::max() / i) {
+            return std::numeric_limits<long long>::max();
+        }
         result *= i;
     }
     return result;
 }
 
+// 排列数的文字, 饱和值显示为 "> 9.2e18"
+QString CityManager::permutationCountText(long long count) {
+    if (count == std::numeric_limits<long long>::max()) {
+        return "> 9.2e18";
+    }
+    return QString::number(count);
+}
+
 // 穷举法解决旅行商问题
-QList<City> CityManager::solveTSP(QList<BruteForceStep>* steps) const {
+QList<City> CityManager::solveTSP(StepSink<BruteForceStep>* steps) const {
     QList<City> result;
     int n = getCityCount(); // 获取所有城市数量
 
     if (n < 2) return result;
 
-    // 创建城市列表
+    // 创建城市列表, 距离一次性算好, 内层循环只按编号查表
     QList<City> cityList = getAllCities();
+    DistanceMatrix<double> dist(getCoordinates());
 
     // 初始排列 [0, 1, 2, ..., n-1]
     QList<int> indices;
@@ -181,12 +346,11 @@ QList<City> CityManager::solveTSP(QList<BruteForceStep>* steps) const {
 
     double minDistance = std::numeric_limits<double>::max(); // 使用double最大值作为初始值
     QList<int> optimalPath; // 选择的路径
-    int iteration = 0; // 初始化迭代次数为0
-    int totalPermutations = factorial(n);
+    qint64 iteration = 0; // 已计算的排列数
+    long long totalPermutations = factorial(n);
 
     // 初始化日志
     if (steps) {
-        steps->clear();
         BruteForceStep initStep;
         initStep.iteration = iteration;
         initStep.currentPath = QList<City>(); // 初始为空
@@ -194,7 +358,7 @@ QList<City> CityManager::solveTSP(QList<BruteForceStep>* steps) const {
         initStep.totalPermutations = totalPermutations;
         initStep.bestDistance = minDistance;
         initStep.message = QString("开始穷举法 (城市数: %1, 总排列数: %2)")
-                               .arg(n).arg(initStep.totalPermutations);
+                               .arg(n).arg(permutationCountText(initStep.totalPermutations));
         steps->append(initStep);
     }
 
@@ -203,11 +367,12 @@ QList<City> CityManager::solveTSP(QList<BruteForceStep>* steps) const {
         double currentDistance = 0;
 
         // 计算当前路径的总距离
+        const int *order = indices.constData();
         for (int i = 0; i < n - 1; ++i) {
-            currentDistance += distance(cityList[indices[i]], cityList[indices[i+1]]);
+            currentDistance += dist(order[i], order[i+1]);
         }
         // 回到起点
-        currentDistance += distance(cityList[indices[n-1]], cityList[indices[0]]);
+        currentDistance += dist(order[n-1], order[0]);
 
 
         bool isNewBest = false;
@@ -216,31 +381,32 @@ QList<City> CityManager::solveTSP(QList<BruteForceStep>* steps) const {
             minDistance = currentDistance;
             optimalPath = indices;
             isNewBest = true;
+            publishTour([&]() -> const QList<int>& { return optimalPath; });
         }
 
-        // 记录当前步骤 (每一千步)
-        if (steps && (iteration++ % 1000 == 0)) {
-            BruteForceStep step;
-            step.iteration = iteration++;
-            step.totalPermutations = totalPermutations;
-            step.currentPath = buildPathFromIndices(cityList, indices);
-            step.currentDistance = currentDistance;
-            step.bestDistance = minDistance;
-
-            if (isNewBest) {
-                step.message = QString("找到更优解: 距离=%1")
-                                   .arg(currentDistance, 8, 'f', 3); // 数值占用的最小字符数8,浮点数表示,保留到小数点后三位
-            } else {
-                step.message = QString("当前路径距离=%1 (最优=%2)")
-                                   .arg(currentDistance, 8, 'f', 3)
-                                   .arg(minDistance, 8, 'f', 3);
-            }
-
-            if(step.iteration<=step.totalPermutations)
-                steps->append(step);
+        // 每一千个排列采样记录一次; 采样步骤不带路径, 完整路径只在最后一步给出
+        iteration++;
+        if (iteration % 1000 == 1) {
+            addStep(steps, minDistance, [&]() {
+                BruteForceStep step;
+                step.iteration = iteration;
+                step.totalPermutations = totalPermutations;
+                step.currentDistance = currentDistance;
+                step.bestDistance = minDistance;
+
+                if (isNewBest) {
+                    step.message = QString("找到更优解: 距离=%1")
+                                       .arg(currentDistance, 8, 'f', 3); // 数值占用的最小字符数8,浮点数表示,保留到小数点后三位
+                } else {
+                    step.message = QString("当前路径距离=%1 (最优=%2)")
+                                       .arg(currentDistance, 8, 'f', 3)
+                                       .arg(minDistance, 8, 'f', 3);
+                }
+                return step;
+            });
         }
 
-    } while (std::next_permutation(indices.begin(), indices.end())); // 生成字典序的下一种排列组合
+    } while (!isCancelled() && std::next_permutation(indices.begin(), indices.end())); // 生成字典序的下一种排列组合
 
     // 构建最优路径的城市列表
     if (!optimalPath.isEmpty()) {
@@ -252,6 +418,202 @@ QList<City> CityManager::solveTSP(QList<BruteForceStep>* steps) const {
     }
 
     // 添加最终结果日志
+    if (steps) {
+        BruteForceStep finalStep;
+        finalStep.iteration = iteration;
+        finalStep.currentPath = result;
+        finalStep.currentDistance = minDistance;
+        finalStep.totalPermutations = totalPermutations;
+        finalStep.bestDistance = minDistance;
+        finalStep.message = QString(isCancelled() ? "穷举已取消，目前最优解: 距离=%1" : "穷举完成，找到最优解: 距离=%1")
+                                .arg(minDistance, 8, 'f', 3);
+        steps->append(finalStep);
+    }
+
+    return result;
+}
+
+namespace {
+
+// 原子地把 best 降为 value(若 value 更小)
+void lowerBound(std::atomic<double> &best, double value) {
+    double current = best.load(std::memory_order_relaxed);
+    while (value < current && !best.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// 一个前缀任务的深度优先搜索状态
+// 剩余城市按编号从小到大选择, 枚举顺序与 std::next_permutation 的字典序一致
+struct PrefixSearch {
+    const double *dist = nullptr;
+    int n = 0;
+    std::atomic<double> *globalBest = nullptr;
+    const std::atomic<bool> *cancel = nullptr; // 取消标志, 可为空
+
+    std::vector<int> perm;
+    std::vector<char> used;
+    double localBest = std::numeric_limits<double>::max();
+    std::vector<int> localPath;
+    qint64 evaluated = 0; // 完整计算的排列数
+    qint64 pruned = 0;    // 被剪掉的子树数
+
+    void search(int depth, double partial) {
+        if (depth == n) {
+            // 累加顺序与单线程版本相同, 浮点结果逐位一致
+            double total = partial + dist[perm[n - 1] * n + perm[0]];
+            evaluated++;
+            if (total < localBest) {
+                localBest = total;
+                localPath = perm;
+                lowerBound(*globalBest, total);
+            }
+            return;
+        }
+
+        if (cancel && cancel->load(std::memory_order_relaxed)) return;
+
+        // 部分路径已经严格大于已知最优, 后面的排列不可能更优或与之相等
+        double bound = qMin(localBest, globalBest->load(std::memory_order_relaxed));
+        if (partial > bound) {
+            pruned++;
+            return;
+        }
+
+        int last = perm[depth - 1];
+        for (int c = 0; c < n; ++c) {
+            if (used[c]) continue;
+            used[c] = 1;
+            perm[depth] = c;
+            search(depth + 1, partial + dist[last * n + c]);
+            used[c] = 0;
+        }
+    }
+};
+
+// 按字典序生成所有长度为 length 的前缀
+void collectPrefixes(int n, int length, std::vector<int> &prefix, std::vector<char> &used,
+                     QList<std::vector<int>> &prefixes) {
+    if (static_cast<int>(prefix.size()) == length) {
+        prefixes.append(prefix);
+        return;
+    }
+    for (int c = 0; c < n; ++c) {
+        if (used[c]) continue;
+        used[c] = 1;
+        prefix.push_back(c);
+        collectPrefixes(n, length, prefix, used, prefixes);
+        prefix.pop_back();
+        used[c] = 0;
+    }
+}
+
+} // namespace
+
+// 多线程穷举法
+QList<City> CityManager::solveTSPParallel(StepSink<BruteForceStep>* steps, int threadCount) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    QList<City> cityList = getAllCities();
+
+    // 距离矩阵与单线程 solveTSP 相同, 累加结果逐位一致
+    DistanceMatrix<double> dist(getCoordinates());
+
+    WorkStealingPool pool(threadCount);
+    long long totalPermutations = factorial(n);
+
+    // 选择前缀长度, 使任务数至少是线程数的 16 倍, 便于负载均衡
+    int prefixLength = 1;
+    long long taskCount = n;
+    while (taskCount < 16LL * pool.threadCount() && prefixLength < n - 1) {
+        taskCount *= n - prefixLength;
+        prefixLength++;
+    }
+
+    QList<std::vector<int>> prefixes;
+    std::vector<int> prefix;
+    std::vector<char> used(n, 0);
+    collectPrefixes(n, prefixLength, prefix, used, prefixes);
+
+    if (steps) {
+        BruteForceStep initStep;
+        initStep.iteration = 0;
+        initStep.currentDistance = 0;
+        initStep.totalPermutations = totalPermutations;
+        initStep.bestDistance = std::numeric_limits<double>::max();
+        initStep.message = QString("开始多线程穷举 (城市数: %1, 线程数: %2, 前缀长度: %3, 任务数: %4)")
+                               .arg(n).arg(pool.threadCount()).arg(prefixLength).arg(prefixes.size());
+        steps->append(initStep);
+    }
+
+    std::atomic<double> globalBest(std::numeric_limits<double>::max());
+    std::atomic<int> finishedTasks(0);
+    std::mutex tourMutex; // 回路快照只允许一个写线程, 各任务发布时加锁
+    QList<PrefixSearch> searches(prefixes.size());
+
+    pool.run(prefixes.size(), [&](int index, int) {
+        PrefixSearch &search = searches[index];
+        search.dist = dist.data();
+        search.n = n;
+        search.globalBest = &globalBest;
+        search.cancel = cancelFlag();
+        search.perm.assign(n, 0);
+        search.used.assign(n, 0);
+
+        // 前缀部分的距离按顺序累加
+        double partial = 0;
+        for (int i = 0; i < prefixLength; ++i) {
+            search.perm[i] = prefixes[index][i];
+            search.used[search.perm[i]] = 1;
+            if (i > 0) partial += dist(search.perm[i - 1], search.perm[i]);
+        }
+        search.search(prefixLength, partial);
+
+        int finished = ++finishedTasks;
+        publishProgress(globalBest.load(std::memory_order_relaxed),
+                        QString("已完成前缀任务 %1/%2").arg(finished).arg(prefixes.size()));
+
+        // 本任务的最优解就是目前的全局最优时发布回路
+        if (!search.localPath.empty() && search.localBest <= globalBest.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(tourMutex);
+            publishTour([&]() -> const std::vector<int>& { return search.localPath; });
+        }
+    });
+
+    // 按前缀的字典序合并, 距离相同时保留字典序最小的排列, 与单线程结果一致
+    double minDistance = std::numeric_limits<double>::max();
+    const std::vector<int> *optimalPath = nullptr;
+    qint64 evaluated = 0;
+    qint64 pruned = 0;
+    for (int i = 0; i < searches.size(); ++i) {
+        const PrefixSearch &search = searches[i];
+        evaluated += search.evaluated;
+        pruned += search.pruned;
+        if (!search.localPath.empty() && search.localBest < minDistance) {
+            minDistance = search.localBest;
+            optimalPath = &search.localPath;
+
+            if (steps) {
+                steps->add([&]() {
+                    BruteForceStep step;
+                    step.iteration = qMin<qint64>(evaluated, totalPermutations);
+                    step.totalPermutations = totalPermutations;
+                    step.currentDistance = search.localBest;
+                    step.bestDistance = minDistance;
+                    step.message = QString("任务 %1/%2 找到更优解: 距离=%3")
+                                       .arg(i + 1).arg(searches.size())
+                                       .arg(minDistance, 8, 'f', 3);
+                    return step;
+                });
+            }
+        }
+    }
+
+    if (optimalPath) {
+        result = buildPathFromIndices(cityList, QList<int>(optimalPath->begin(), optimalPath->end()));
+    }
+
     if (steps) {
         BruteForceStep finalStep;
         finalStep.iteration = totalPermutations;
@@ -259,7 +621,9 @@ QList<City> CityManager::solveTSP(QList<BruteForceStep>* steps) const {
         finalStep.currentDistance = minDistance;
         finalStep.totalPermutations = totalPermutations;
         finalStep.bestDistance = minDistance;
-        finalStep.message = QString("穷举完成，找到最优解: 距离=%1")
+        finalStep.message = QString(isCancelled() ? "多线程穷举已取消，完整计算 %1 个排列，剪枝 %2 次，目前最优解: 距离=%3"
+                                                  : "多线程穷举完成，完整计算 %1 个排列，剪枝 %2 次，最优解: 距离=%3")
+                                .arg(evaluated).arg(pruned)
                                 .arg(minDistance, 8, 'f', 3);
         steps->append(finalStep);
     }
@@ -267,68 +631,845 @@ QList<City> CityManager::solveTSP(QList<BruteForceStep>* steps) const {
     return result;
 }
 
-/***************************模拟退火算法********************************/
+namespace {
+
+// 剪枝穷举的搜索状态
+// 城市 0 固定为起点; 要求 path[1] < path[n-1], 每条回路与它的镜像只保留一条
+struct PrunedSearch {
+    const double *dist = nullptr;
+    int n = 0;
+    std::vector<double> halfEdges;  // 每个城市最短两条边之和的一半
+    std::vector<double> halfMin;    // 每个城市最短边的一半
+    std::vector<int> order;         // order[c]: 城市 c 的其他城市按距离从近到远排序, 用于优先搜索近邻
+    std::vector<int> path;
+    std::vector<char> used;
+    double remainingHalf = 0;       // 未访问城市的 halfEdges 之和
+    int largerLeft = 0;             // 未访问城市中编号大于 path[1] 的个数, 最后一个城市必须从中选
+
+    double best = std::numeric_limits<double>::max();
+    std::vector<int> bestPath;
+    qint64 tours = 0;  // 完整计算的回路数
+    qint64 nodes = 0;  // 搜索树节点数
+    qint64 pruned = 0; // 被下界剪掉的子树数
+    StepSink<BruteForceStep> *steps = nullptr;
+    SolverControl *control = nullptr; // 取消标志和进度, 可为空
+    long long totalTours = 0;
+
+    // 最短两条边下界: 剩余路径上每个未访问城市关联两条边, 当前城市和起点各关联一条,
+    // 每条边的长度平分给两个端点, 端点分到的份额不少于它最短边(或最短两条边)的一半
+    double lowerBound(int current) const {
+        return remainingHalf + halfMin[current] + halfMin[0];
+    }
 
-// 生成初始解
-QList<City> CityManager::generateInitialSolution(const QList<City>& cities) {
-    int n = cities.size();
-    if (n <= 2) return cities; // 直接返回
+    void search(int depth, double partial) {
+        nodes++;
+        int current = path[depth - 1];
+
+        if (depth == n) {
+            double total = partial + dist[current * n];
+            tours++;
+            if (total < best) {
+                best = total;
+                bestPath = path;
+                if (control && control->tourDue()) control->publishTour(bestPath);
+                if (steps) {
+                    steps->add([&]() {
+                        BruteForceStep step;
+                        step.iteration = tours;
+                        step.totalPermutations = totalTours;
+                        step.currentDistance = total;
+                        step.bestDistance = best;
+                        step.message = QString("找到更优解: 距离=%1 (已搜索 %2 个节点)")
+                                           .arg(total, 8, 'f', 3).arg(nodes);
+                        if (control) control->publish(best, step.message);
+                        return step;
+                    });
+                }
+            }
+            return;
+        }
 
-    // 改进的贪心算法：从随机城市开始，每次选择最近且能高效回到起点的下一个城市
-    QList<City> path;
-    QSet<QString> visited;
-
-    // 随机选择起点
-    std::random_device rd; // 获取随机种子的设备对象
-    std::mt19937 gen(rd()); // 基于梅森旋转算法的伪随机数生成器
-    std::uniform_int_distribution<> dis(0, n-1); // 指定生成随机整数的范围是 [0, n - 1]
-    int startIdx = dis(gen); // 生成一个在 [0, n - 1] 范围内的随机整数，作为要选择城市的索引
-    path.append(cities[startIdx]); // 加入路径
-    visited.insert(cities[startIdx].name); // 标记已访问
-
-    // 构建路径
-    while (path.size() < n) {
-        City last = path.last(); // 当前路径的最后一个城市
-        City bestNext; // 存储最优的下一城市
-        double minCost = std::numeric_limits<double>::max(); // 定义默认成本为double的最大值
-
-        // 寻找下一个城市，同时考虑最终回到起点的成本
-        for (const auto& city : cities) {
-            if (visited.contains(city.name)) continue; // 若已访问则跳过
-
-            // 计算从last到city的距离 + city回到起点的距离
-            double cost = distance(last, city) + distance(city, path.first());
-
-            if (cost < minCost) {
-                minCost = cost;
-                bestNext = city;
+        if (control && control->isCancelled()) return;
+
+        if (partial + lowerBound(current) >= best) {
+            pruned++;
+            return;
+        }
+
+        const int *candidates = &order[current * (n - 1)];
+        for (int i = 0; i < n - 1; ++i) {
+            int c = candidates[i];
+            if (used[c] || c == 0) continue;
+
+            // 镜像约束: path[1] 之后必须至少留一个更大的城市作为终点
+            bool larger = depth > 1 && c > path[1];
+            if (depth == 1) {
+                largerLeft = n - 1 - c;
+                if (n > 3 && largerLeft == 0) continue;
+            } else if (depth < n - 1 && larger && largerLeft == 1) {
+                continue;
+            } else if (depth == n - 1 && n > 3 && !larger) {
+                continue;
             }
+
+            used[c] = 1;
+            path[depth] = c;
+            remainingHalf -= halfEdges[c];
+            if (larger) largerLeft--;
+
+            search(depth + 1, partial + dist[current * n + c]);
+
+            if (larger) largerLeft++;
+            remainingHalf += halfEdges[c];
+            used[c] = 0;
         }
+    }
+};
+
+} // namespace
 
-        // 筛选出的 “最优下一个城市” 加入路径
-        path.append(bestNext);
-        visited.insert(bestNext.name);
+// 剪枝穷举法
+QList<City> CityManager::solveTSPWithPruning(StepSink<BruteForceStep>* steps) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    QList<City> cityList = getAllCities();
+    DistanceMatrix<double> dist(getCoordinates());
+
+    PrunedSearch search;
+    search.dist = dist.data();
+    search.n = n;
+    search.steps = steps;
+    search.control = solverControl;
+    long long permutations = factorial(n - 1);
+    search.totalTours = n <= 2 ? 1
+                        : permutations == std::numeric_limits<long long>::max() ? permutations : permutations / 2;
+    search.halfEdges.assign(n, 0);
+    search.halfMin.assign(n, 0);
+    search.order.resize(n * (n - 1));
+
+    for (int i = 0; i < n; ++i) {
+        int *row = &search.order[i * (n - 1)];
+        int k = 0;
+        for (int j = 0; j < n; ++j) {
+            if (j != i) row[k++] = j;
+        }
+        std::sort(row, row + n - 1, [&](int a, int b) {
+            return dist(i, a) < dist(i, b);
+        });
+        double first = dist(i, row[0]);
+        double second = n > 2 ? dist(i, row[1]) : first;
+        search.halfEdges[i] = (first + second) / 2;
+        search.halfMin[i] = first / 2;
+        if (i != 0) search.remainingHalf += search.halfEdges[i];
     }
 
-    return path;
+    if (steps) {
+        BruteForceStep initStep;
+        initStep.iteration = 0;
+        initStep.currentDistance = 0;
+        initStep.totalPermutations = search.totalTours;
+        initStep.bestDistance = std::numeric_limits<double>::max();
+        initStep.message = QString("开始剪枝穷举 (城市数: %1, 去除旋转和镜像后的回路数: %2)")
+                               .arg(n).arg(permutationCountText(search.totalTours));
+        steps->append(initStep);
+    }
+
+    search.path.assign(n, 0);
+    search.used.assign(n, 0);
+    search.used[0] = 1;
+    search.search(1, 0.0);
+
+    result = buildPathFromIndices(cityList, QList<int>(search.bestPath.begin(), search.bestPath.end()));
+
+    if (steps) {
+        BruteForceStep finalStep;
+        finalStep.iteration = search.tours;
+        finalStep.currentPath = result;
+        finalStep.currentDistance = search.best;
+        finalStep.totalPermutations = search.totalTours;
+        finalStep.bestDistance = search.best;
+        finalStep.message = QString(isCancelled() ? "剪枝穷举已取消，搜索 %1 个节点，完整计算 %2 条回路，剪枝 %3 次，目前最优解: 距离=%4"
+                                                  : "剪枝穷举完成，搜索 %1 个节点，完整计算 %2 条回路，剪枝 %3 次，最优解: 距离=%4")
+                                .arg(search.nodes).arg(search.tours).arg(search.pruned)
+                                .arg(search.best, 8, 'f', 3);
+        steps->append(finalStep);
+    }
+
+    return result;
 }
 
-// 简化的 2-opt 优化
-QList<City> CityManager::generateNeighbor(const QList<City>& solution) {
-    QList<City> neighbor = solution;
-    int n = neighbor.size();
-    if (n <= 2) return neighbor;
+/***************************动态规划(Held-Karp)********************************/
+
+// 估算 Held-Karp 所需内存
+// 固定第 0 个城市为起点, 其余 m = n-1 个城市的子集 S 只为 S 中的终点保存状态, 共 m·2^(m-1) 个状态;
+// 每个状态保存 double 距离(8 字节)和前驱城市(1 字节), 另有 2^m 个子集偏移量和 n² 的距离表;
+// 距离用 double 累加, float 只有 7 位有效数字, 区分不了长度相差约 1e-7 倍的回路, 不能保证最优
+qint64 CityManager::estimateHeldKarpMemory(int cityCount) {
+    if (cityCount < 2) return 0;
+    int m = cityCount - 1;
+    if (m > 31) return std::numeric_limits<qint64>::max();
+
+    qint64 subsets = 1LL << m;
+    qint64 states = m * (subsets / 2);
+    return states * static_cast<qint64>(sizeof(double) + sizeof(quint8))
+           + subsets * static_cast<qint64>(sizeof(quint32))
+           + static_cast<qint64>(cityCount) * cityCount * static_cast<qint64>(sizeof(double));
+}
 
-    // 随机交换两个索引
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, n-1);
-    int i = dis(gen);
-    int j = dis(gen);
-    while (i == j) j = dis(gen);
-    std::swap(neighbor[i], neighbor[j]);
+// 设置 Held-Karp 内存上限
+void CityManager::setHeldKarpMemoryLimit(qint64 bytes) {
+    heldKarpMemoryLimit = bytes;
+}
 
-    return neighbor;
+// 获取 Held-Karp 内存上限
+qint64 CityManager::getHeldKarpMemoryLimit() const {
+    return heldKarpMemoryLimit;
+}
+
+// 状态压缩动态规划求解旅行商问题
+// dp[S][j]: 从起点出发, 恰好经过子集 S 中的城市并停在 j(j ∈ S) 的最短距离
+// dp[S][j] = min{ dp[S - {j}][k] + d(k, j) | k ∈ S - {j} }
+QList<City> CityManager::solveTSPWithHeldKarp(StepSink<HeldKarpStep>* steps) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    const int MAX_CITIES = 29; // 状态编号用 32 位整数, 前驱用 8 位整数
+    qint64 memoryBytes = estimateHeldKarpMemory(n);
+    if (n > MAX_CITIES || memoryBytes > heldKarpMemoryLimit) {
+        if (steps) {
+            HeldKarpStep step;
+            step.processedSubsets = 0;
+            step.totalSubsets = 0;
+            step.memoryBytes = memoryBytes;
+            step.bestDistance = 0;
+            if (n > MAX_CITIES) {
+                step.message = QString("城市数 %1 超过动态规划支持的上限 %2, 拒绝求解")
+                                   .arg(n).arg(MAX_CITIES);
+            } else {
+                step.message = QString("预计需要内存 %1 MB, 超过上限 %2 MB, 拒绝求解")
+                                   .arg(memoryBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                                   .arg(heldKarpMemoryLimit / (1024.0 * 1024.0), 0, 'f', 1);
+            }
+            steps->append(step);
+        }
+        return result;
+    }
+
+    QList<City> cityList = getAllCities();
+    int m = n - 1; // 除起点外的城市数, 第 i 位对应城市 i+1
+    quint32 subsets = 1u << m;
+    quint32 full = subsets - 1;
+
+    // double 距离表, 与动态规划表的精度一致
+    DistanceMatrix<double> dist(getCoordinates());
+
+    // 子集 S 的状态从 offset[S] 开始连续存放, S 中第 r 小的终点位于 offset[S] + r
+    std::vector<quint32> offset(subsets);
+    quint32 total = 0;
+    for (quint32 S = 0; S < subsets; ++S) {
+        offset[S] = total;
+        total += qPopulationCount(S);
+    }
+    std::vector<double> dp(total);
+    std::vector<quint8> parent(total);
+    const quint8 FROM_START = 0xFF; // 前驱为起点
+
+    if (steps) {
+        HeldKarpStep step;
+        step.processedSubsets = 0;
+        step.totalSubsets = subsets - 1;
+        step.memoryBytes = memoryBytes;
+        step.bestDistance = 0;
+        step.message = QString("开始动态规划 (城市数: %1, 状态数: %2, 预计内存: %3 MB)")
+                           .arg(n).arg(total)
+                           .arg(memoryBytes / (1024.0 * 1024.0), 0, 'f', 1);
+        steps->append(step);
+    }
+
+    // 子集按数值从小到大处理, S - {j} 一定比 S 先算完
+    quint32 logInterval = qMax(1u, subsets / 16);
+    for (quint32 S = 1; S < subsets; ++S) {
+        quint32 base = offset[S];
+        int r = 0;
+        for (quint32 bits = S; bits; bits &= bits - 1, ++r) {
+            int j = qCountTrailingZeroBits(bits);
+            quint32 prev = S & ~(1u << j);
+            const double *toJ = dist.row(j + 1);
+
+            if (prev == 0) {
+                dp[base + r] = toJ[0];
+                parent[base + r] = FROM_START;
+                continue;
+            }
+
+            double best = std::numeric_limits<double>::max();
+            int bestK = 0;
+            const double *prevRow = &dp[offset[prev]];
+            int rk = 0;
+            for (quint32 prevBits = prev; prevBits; prevBits &= prevBits - 1, ++rk) {
+                int k = qCountTrailingZeroBits(prevBits);
+                double value = prevRow[rk] + toJ[k + 1];
+                if (value < best) {
+                    best = value;
+                    bestK = k;
+                }
+            }
+            dp[base + r] = best;
+            parent[base + r] = static_cast<quint8>(bestK);
+        }
+
+        if (S % logInterval == 0) {
+            addStep(steps, 0, [&]() {
+                HeldKarpStep step;
+                step.processedSubsets = S;
+                step.totalSubsets = subsets - 1;
+                step.memoryBytes = memoryBytes;
+                step.bestDistance = 0;
+                step.message = QString("已处理子集 %1/%2").arg(S).arg(subsets - 1);
+                return step;
+            });
+        }
+
+        // 动态规划表没有填完就没有任何完整回路, 取消时只能放弃
+        if (isCancelled()) {
+            if (steps) {
+                HeldKarpStep step;
+                step.processedSubsets = S;
+                step.totalSubsets = subsets - 1;
+                step.memoryBytes = memoryBytes;
+                step.bestDistance = 0;
+                step.message = QString("动态规划已取消 (已处理子集 %1/%2)").arg(S).arg(subsets - 1);
+                steps->append(step);
+            }
+            return result;
+        }
+    }
+
+    // 选择回到起点后总距离最短的终点
+    double best = std::numeric_limits<double>::max();
+    int last = 0;
+    int r = 0;
+    for (quint32 bits = full; bits; bits &= bits - 1, ++r) {
+        int j = qCountTrailingZeroBits(bits);
+        double value = dp[offset[full] + r] + dist(j + 1, 0);
+        if (value < best) {
+            best = value;
+            last = j;
+        }
+    }
+
+    // 沿前驱表倒推路径
+    QList<int> order;
+    quint32 S = full;
+    int j = last;
+    while (true) {
+        order.prepend(j + 1);
+        quint32 index = offset[S] + qPopulationCount(S & ((1u << j) - 1));
+        quint8 k = parent[index];
+        if (k == FROM_START) break;
+        S &= ~(1u << j);
+        j = k;
+    }
+    order.prepend(0);
+
+    result = buildPathFromIndices(cityList, order);
+
+    if (steps) {
+        HeldKarpStep step;
+        step.processedSubsets = subsets - 1;
+        step.totalSubsets = subsets - 1;
+        step.memoryBytes = memoryBytes;
+        step.bestDistance = 0;
+        for (int i = 0; i + 1 < result.size(); ++i) {
+            step.bestDistance += distance(result[i], result[i + 1]);
+        }
+        step.message = QString("动态规划完成，找到最优解: 距离=%1")
+                           .arg(step.bestDistance, 8, 'f', 3);
+        steps->append(step);
+    }
+
+    return result;
+}
+
+/***************************分支定界********************************/
+
+// 分支定界法
+QList<City> CityManager::solveTSPWithBranchAndBound(StepSink<BranchAndBoundStep>* steps, qint64 timeLimitMs) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    QList<City> cityList = getAllCities();
+    DistanceMatrix<double> dist(getCoordinates());
+
+    // 初始上界: 最近邻回路再用 2-opt 改进到局部最优
+    std::vector<int> tour;
+    std::vector<char> visited(n, 0);
+    tour.push_back(0);
+    visited[0] = 1;
+    for (int step = 1; step < n; ++step) {
+        int current = tour.back();
+        int next = -1;
+        for (int w = 0; w < n; ++w) {
+            if (!visited[w] && (next < 0 || dist(current, w) < dist(current, next))) next = w;
+        }
+        visited[next] = 1;
+        tour.push_back(next);
+    }
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (int i = 0; i < n - 1; ++i) {
+            for (int j = i + 2; j < n; ++j) {
+                int a = tour[i], b = tour[i + 1], c = tour[j], d = tour[(j + 1) % n];
+                if (a == d) continue;
+                double delta = dist(a, c) + dist(b, d) - dist(a, b) - dist(c, d);
+                if (delta < -1e-10) {
+                    std::reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    BranchAndBound solver(dist);
+    solver.setInitialTour(tour);
+    solver.setTimeLimit(timeLimitMs);
+    solver.setCancelFlag(cancelFlag());
+
+    auto makeStep = [](const BranchAndBound::Progress &progress) {
+        BranchAndBoundStep step;
+        step.nodes = progress.nodes;
+        step.nodesPerSecond = progress.nodesPerSecond;
+        step.lowerBound = progress.lowerBound;
+        step.upperBound = progress.upperBound;
+        step.gap = progress.gap;
+        return step;
+    };
+
+    if (steps) {
+        BranchAndBoundStep step;
+        step.nodes = 0;
+        step.nodesPerSecond = 0;
+        step.lowerBound = 0;
+        step.upperBound = 0;
+        for (int i = 0; i < n; ++i) step.upperBound += dist(tour[i], tour[(i + 1) % n]);
+        step.gap = 1;
+        step.message = QString("开始分支定界 (城市数: %1, 初始上界: %2)").arg(n).arg(step.upperBound, 0, 'f', 3);
+        steps->append(step);
+    }
+
+    solver.setProgressCallback([this, steps, makeStep](const BranchAndBound::Progress &progress) {
+        if (progress.tour) publishTour([&]() -> const std::vector<int>& { return *progress.tour; });
+        addStep(steps, progress.upperBound, [&]() {
+            BranchAndBoundStep step = makeStep(progress);
+            step.message = QString("%1节点 %2, 速度 %3 节点/秒, 待处理 %4, 差距 %5%")
+                               .arg(progress.improved ? "找到更优解; " : "")
+                               .arg(progress.nodes)
+                               .arg(progress.nodesPerSecond, 0, 'f', 0)
+                               .arg(progress.openNodes)
+                               .arg(progress.gap * 100, 0, 'f', 3);
+            return step;
+        });
+    });
+
+    tour = solver.solve();
+    result = buildPathFromIndices(cityList, QList<int>(tour.begin(), tour.end()));
+
+    if (steps) {
+        BranchAndBoundStep step = makeStep(solver.lastProgress());
+        if (solver.isOptimal()) {
+            step.message = QString("分支定界完成，已证明最优: 距离=%1, 共 %2 个节点")
+                               .arg(step.upperBound, 8, 'f', 3).arg(step.nodes);
+        } else {
+            step.message = QString(isCancelled() ? "已取消，当前最优: 距离=%1, 下界=%2, 差距 %3%"
+                                                 : "达到时间上限，当前最优: 距离=%1, 下界=%2, 差距 %3%")
+                               .arg(step.upperBound, 8, 'f', 3)
+                               .arg(step.lowerBound, 8, 'f', 3)
+                               .arg(step.gap * 100, 0, 'f', 3);
+        }
+        steps->append(step);
+    }
+
+    return result;
+}
+
+/***************************Christofides********************************/
+
+// 最小生成树 + 奇度顶点匹配 + 欧拉回路抄近路, 可选局部搜索改进
+QList<City> CityManager::solveTSPWithChristofides(StepSink<ChristofidesStep>* steps, bool polish) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    QList<City> cityList = getAllCities();
+    CityCoordinates coords = getCoordinates();
+    QElapsedTimer timer;
+    timer.start();
+
+    Christofides solver(coords);
+    std::vector<int> tour = solver.solve();
+    const Christofides::Stats &stats = solver.lastStats();
+    publishTour([&]() -> const std::vector<int>& { return tour; });
+
+    auto addStep = [this, steps, &timer](double lowerBound, double distance, const QString &message) {
+        ChristofidesStep step;
+        step.lowerBound = lowerBound;
+        step.distance = distance;
+        step.elapsedMs = timer.elapsed();
+        step.message = message;
+        steps->append(step);
+        publishProgress(distance, message);
+    };
+
+    if (steps && n > 3) {
+        addStep(stats.mstWeight, 0,
+                QString("最小生成树(%1): 权重=%2, 奇度顶点 %3 个, 用时 %4 ms")
+                    .arg(stats.exactMst ? "完全图 Prim" : "k 近邻图 Kruskal")
+                    .arg(stats.mstWeight, 8, 'f', 3)
+                    .arg(stats.oddVertices)
+                    .arg(stats.mstMs));
+        addStep(stats.mstWeight, stats.eulerLength,
+                QString("奇度顶点匹配(%1): 权重=%2, 欧拉回路长度=%3, 用时 %4 ms")
+                    .arg(stats.exactMatching ? "精确" : "贪心 + 交换改进")
+                    .arg(stats.matchingWeight, 8, 'f', 3)
+                    .arg(stats.eulerLength, 8, 'f', 3)
+                    .arg(stats.matchingMs));
+        addStep(stats.mstWeight, stats.tourLength,
+                QString("欧拉回路抄近路: 距离=%1, 为最小生成树的 %2 倍, 用时 %3 ms")
+                    .arg(stats.tourLength, 8, 'f', 3)
+                    .arg(stats.tourLength / stats.mstWeight, 0, 'f', 3)
+                    .arg(stats.tourMs));
+    }
+
+    if (polish && n > 3 && !isCancelled()) {
+        LocalSearch<> search(coords);
+        search.setCancelFlag(cancelFlag());
+        double length = search.optimize(tour);
+        if (steps) {
+            addStep(stats.mstWeight, length,
+                    QString(isCancelled() ? "局部搜索已取消: 距离=%1, 改进 %2%, 为最小生成树的 %3 倍"
+                                          : "局部搜索改进: 距离=%1, 改进 %2%, 为最小生成树的 %3 倍")
+                        .arg(length, 8, 'f', 3)
+                        .arg((1 - length / stats.tourLength) * 100, 0, 'f', 2)
+                        .arg(length / stats.mstWeight, 0, 'f', 3));
+        }
+    }
+
+    result = buildPathFromIndices(cityList, QList<int>(tour.begin(), tour.end()));
+    return result;
+}
+
+/***************************局部搜索********************************/
+
+namespace {
+
+// 几千个城市以内两种回路表示的效果相当, 更大时两级链表的长路径翻转快得多
+const int TWO_LEVEL_TOUR_THRESHOLD = 5000;
+
+} // namespace
+
+// 最近邻 + 2-opt/Or-opt 局部搜索
+QList<City> CityManager::solveTSPWithLocalSearch(StepSink<LocalSearchStep>* steps, int neighborCount) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    QList<City> cityList = getAllCities();
+    CityCoordinates coords = getCoordinates();
+    bool twoLevel = n >= TWO_LEVEL_TOUR_THRESHOLD;
+    std::vector<int> tour;
+
+    // 按回路表示实例化的局部搜索
+    auto run = [&](auto &search) {
+        search.setCancelFlag(cancelFlag());
+        tour = search.nearestNeighborTour();
+        publishTour([&]() -> const std::vector<int>& { return tour; });
+
+        if (steps) {
+            LocalSearchStep step;
+            step.twoOptMoves = 0;
+            step.orOptMoves = 0;
+            step.distance = search.tourLength(tour);
+            step.elapsedMs = 0;
+            step.message = QString("最近邻初始回路 (城市数: %1, 候选邻居数: %2, 回路表示: %3)")
+                               .arg(n).arg(search.neighborCount())
+                               .arg(twoLevel ? "两级链表" : "数组");
+            steps->append(step);
+            publishProgress(step.distance, step.message);
+        }
+
+        search.optimize(tour);
+
+        if (steps) {
+            const auto &stats = search.lastStats();
+            LocalSearchStep step;
+            step.twoOptMoves = stats.twoOptMoves;
+            step.orOptMoves = stats.orOptMoves;
+            step.distance = stats.finalLength;
+            step.elapsedMs = stats.elapsedMs;
+            step.message = QString(isCancelled() ? "局部搜索已取消: 距离=%1, 改进 %2%"
+                                                 : "局部搜索完成，到达局部最优: 距离=%1, 改进 %2%")
+                               .arg(stats.finalLength, 8, 'f', 3)
+                               .arg((1 - stats.finalLength / stats.initialLength) * 100, 0, 'f', 2);
+            steps->append(step);
+        }
+    };
+    if (twoLevel) {
+        LocalSearch<TwoLevelTour> search(coords, neighborCount);
+        run(search);
+    } else {
+        LocalSearch<ArrayTour> search(coords, neighborCount);
+        run(search);
+    }
+
+    result = buildPathFromIndices(cityList, QList<int>(tour.begin(), tour.end()));
+    return result;
+}
+
+/***************************Lin-Kernighan********************************/
+
+namespace {
+
+// 界面实时显示回路时的回调间隔(毫秒); 每次回调要把回路展开成数组, 百万个城市约几毫秒, 不按帧率回调
+const qint64 LIVE_TOUR_INTERVAL_MS = 100;
+
+// 按回路表示实例化的链式 LK, 进度记入 steps
+template <typename Tour>
+std::vector<int> runLinKernighan(const CityCoordinates &coords, quint64 seed, qint64 timeLimitMs,
+                                 qint64 progressIntervalMs, StepSink<LinKernighanStep>* steps, SolverControl* control) {
+    LinKernighan<Tour> solver(coords);
+    solver.setTimeLimit(timeLimitMs);
+    solver.setSeed(seed);
+    solver.setCancelFlag(control ? control->cancelFlag() : nullptr);
+
+    if (steps || control) {
+        // 有界面时回调更频繁, 用来刷新地图上的回路; 日志仍按 progressIntervalMs 记录
+        qint64 callbackIntervalMs = control ? qMin(progressIntervalMs, LIVE_TOUR_INTERVAL_MS) : progressIntervalMs;
+        qint64 lastLogged = -progressIntervalMs;
+        solver.setProgressCallback([steps, control, progressIntervalMs, lastLogged](
+                                       const typename LinKernighan<Tour>::Progress &progress) mutable {
+            if (control && progress.tour && control->tourDue()) control->publishTour(*progress.tour);
+            if (!steps || progress.elapsedMs - lastLogged < progressIntervalMs) return;
+            lastLogged = progress.elapsedMs;
+            steps->add([&]() {
+                LinKernighanStep step;
+                step.kicks = progress.kicks;
+                step.improvements = progress.improvements;
+                step.distance = progress.length;
+                step.elapsedMs = progress.elapsedMs;
+                step.message = QString("扰动 %1 次, 其中 %2 次变短, 比 LK 局部最优缩短 %3%")
+                                   .arg(progress.kicks).arg(progress.improvements)
+                                   .arg((1 - progress.length / progress.initialLength) * 100, 0, 'f', 3);
+                if (control) control->publish(progress.length, step.message);
+                return step;
+            });
+        }, callbackIntervalMs);
+    }
+
+    std::vector<int> tour = solver.solve();
+
+    if (steps) {
+        const typename LinKernighan<Tour>::Progress &progress = solver.lastProgress();
+        LinKernighanStep step;
+        step.kicks = progress.kicks;
+        step.improvements = progress.improvements;
+        step.distance = progress.length;
+        step.elapsedMs = progress.elapsedMs;
+        step.message = QString(control && control->isCancelled() ? "Lin-Kernighan 已取消: 距离=%1"
+                                                                   : "Lin-Kernighan 完成: 距离=%1")
+                           .arg(progress.length, 8, 'f', 3);
+        steps->append(step);
+    }
+    return tour;
+}
+
+} // namespace
+
+// 链式 Lin-Kernighan
+QList<City> CityManager::solveTSPWithLinKernighan(StepSink<LinKernighanStep>* steps, qint64 timeLimitMs,
+                                                  qint64 progressIntervalMs) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    QList<City> cityList = getAllCities();
+    CityCoordinates coords = getCoordinates();
+    bool twoLevel = n >= TWO_LEVEL_TOUR_THRESHOLD;
+
+    if (steps) {
+        LinKernighanStep step;
+        step.kicks = 0;
+        step.improvements = 0;
+        step.distance = 0;
+        step.elapsedMs = 0;
+        step.message = QString("开始链式 Lin-Kernighan (城市数: %1, 时间上限: %2 秒, 回路表示: %3)")
+                           .arg(n).arg(timeLimitMs / 1000.0, 0, 'f', 1)
+                           .arg(twoLevel ? "两级链表" : "数组");
+        steps->append(step);
+    }
+
+    std::vector<int> tour = twoLevel
+        ? runLinKernighan<TwoLevelTour>(coords, randomSeed, timeLimitMs, progressIntervalMs, steps, solverControl)
+        : runLinKernighan<ArrayTour>(coords, randomSeed, timeLimitMs, progressIntervalMs, steps, solverControl);
+    result = buildPathFromIndices(cityList, QList<int>(tour.begin(), tour.end()));
+
+    return result;
+}
+
+/***************************模拟退火算法********************************/
+
+// 设置随机种子
+void CityManager::setRandomSeed(quint64 seed) {
+    randomSeed = seed;
+}
+
+// 获取随机种子
+quint64 CityManager::getRandomSeed() const {
+    return randomSeed;
+}
+
+// 设置初始回路的构造方法
+void CityManager::setInitialTourMethod(TourConstruction::Method method) {
+    initialTourMethod = method;
+}
+
+// 获取初始回路的构造方法
+TourConstruction::Method CityManager::getInitialTourMethod() const {
+    return initialTourMethod;
+}
+
+// 生成初始解
+QList<int> CityManager::generateInitialSolution(const CityCoordinates& coords, Xoshiro256& gen) const {
+    int n = coords.size();
+    TourConstruction construction(coords);
+    std::vector<int> tour = construction.build(initialTourMethod, n > 0 ? gen.uniform(n) : 0);
+    return QList<int>(tour.begin(), tour.end());
+}
+
+namespace {
+
+// 环形翻转: 从位置 from 开始的 count 个元素(越过末尾时回到开头)
+void reverseCircular(int *tour, int n, int from, int count) {
+    int left = from;
+    int right = (from + count - 1) % n;
+    for (int k = 0; k < count / 2; ++k) {
+        std::swap(tour[left], tour[right]);
+        left = left + 1 == n ? 0 : left + 1;
+        right = right == 0 ? n - 1 : right - 1;
+    }
+}
+
+} // namespace
+
+// 随机生成邻域操作
+// 交换 20%, 2-opt 50%, or-opt 30%; 增量只涉及被删除和新增的边, 与城市数无关
+// 距离直接由坐标计算, 不建 n² 的距离矩阵; 数值与矩阵查表逐位相同
+TourMove CityManager::generateNeighbor(const QList<int>& tour, const CityCoordinates& coords,
+                                       Xoshiro256& gen) const {
+    const int n = tour.size();
+    const int *t = tour.constData();
+    auto at = [&](int pos) { return t[(pos + n) % n]; };
+    auto dist = [&](int a, int b) { return coords.distance(a, b); };
+
+    TourMove move;
+    move.length = 1;
+    move.reversed = false;
+
+    int kind = gen.uniform(10);
+
+    // or-opt 至少需要片段外还有 3 个城市
+    if (kind >= 7 && n >= 5) {
+        move.type = TourMove::OrOpt;
+        move.length = gen.uniform(1, qMin(3, n - 4));
+        move.i = gen.uniform(n);
+        // 插入位置不能落在片段内部或片段前一个位置
+        int offset = gen.uniform(n - move.length - 1);
+        move.j = (move.i + move.length + offset) % n;
+
+        int p = at(move.i - 1), s1 = t[move.i], sL = at(move.i + move.length - 1), q = at(move.i + move.length);
+        int c = t[move.j], e = at(move.j + 1);
+        double removed = dist(p, s1) + dist(sL, q) + dist(c, e);
+        double forward = dist(c, s1) + dist(sL, e);
+        double backward = dist(c, sL) + dist(s1, e);
+        move.reversed = backward < forward;
+        move.delta = dist(p, q) + qMin(forward, backward) - removed;
+        return move;
+    }
+
+    int i = gen.uniform(n);
+    int j = gen.uniform(n);
+    while (i == j) j = gen.uniform(n);
+    if (i > j) std::swap(i, j);
+    move.i = i;
+    move.j = j;
+
+    // 翻转整条路径等于没有变化, 改为交换
+    if (kind >= 2 && !(i == 0 && j == n - 1)) {
+        move.type = TourMove::TwoOpt;
+        int a = at(i - 1), b = t[i], c = t[j], e = at(j + 1);
+        move.delta = dist(a, c) + dist(b, e) - dist(a, b) - dist(c, e);
+        return move;
+    }
+
+    move.type = TourMove::Swap;
+    int a = t[i], b = t[j];
+    if (j == i + 1 || (i == 0 && j == n - 1)) {
+        // 相邻交换: 顺序为 p, x, y, q, 交换后为 p, y, x, q
+        int first = j == i + 1 ? i : j;
+        int x = t[first], y = at(first + 1);
+        int p = at(first - 1), q = at(first + 2);
+        move.delta = dist(p, y) + dist(x, q) - dist(p, x) - dist(y, q);
+    } else {
+        int pi = at(i - 1), ni = t[i + 1], pj = t[j - 1], nj = at(j + 1);
+        move.delta = dist(pi, b) + dist(b, ni) + dist(pj, a) + dist(a, nj)
+                     - dist(pi, a) - dist(a, ni) - dist(pj, b) - dist(b, nj);
+    }
+    return move;
+}
+
+// 执行邻域操作
+void CityManager::applyMove(QList<int>& tour, const TourMove& move) const {
+    const int n = tour.size();
+    int *t = tour.data();
+
+    switch (move.type) {
+    case TourMove::Swap:
+        std::swap(t[move.i], t[move.j]);
+        break;
+    case TourMove::TwoOpt: {
+        // 翻转 i..j 与翻转其余部分得到同一条回路, 选短的一侧
+        int inner = move.j - move.i + 1;
+        if (inner * 2 <= n) {
+            reverseCircular(t, n, move.i, inner);
+        } else {
+            reverseCircular(t, n, (move.j + 1) % n, n - inner);
+        }
+        break;
+    }
+    case TourMove::OrOpt: {
+        // 片段 S 与它和插入点之间的部分 R 交换位置, 用三次翻转完成旋转;
+        // 向后移动时区间为 [S, R], 向前移动时区间为 [R, S], 选较短的区间
+        int L = move.length;
+        int forwardGap = (move.j - (move.i + L - 1) + n) % n;
+        int backwardGap = n - L - forwardGap;
+        if (forwardGap <= backwardGap) {
+            int rest = (move.i + L) % n;
+            if (!move.reversed) reverseCircular(t, n, move.i, L);
+            reverseCircular(t, n, rest, forwardGap);
+            reverseCircular(t, n, move.i, L + forwardGap);
+        } else {
+            int start = (move.j + 1) % n;
+            reverseCircular(t, n, start, backwardGap);
+            if (!move.reversed) reverseCircular(t, n, move.i, L);
+            reverseCircular(t, n, start, L + backwardGap);
+        }
+        break;
+    }
+    }
 }
 
 // 根据城市数量自适应调整参数
@@ -349,7 +1490,7 @@ void CityManager::adjustParameters(int cityCount, double& initialTemp, double& c
 }
 
 // 接受程度计算
-bool CityManager::acceptNewSolution(double energyDiff, double temperature) {
+bool CityManager::acceptNewSolution(double energyDiff, double temperature, Xoshiro256& gen) const {
     // 温度接近于0,算法已收敛，拒绝所有新解
     if (temperature <= 1e-10) return false;
 
@@ -357,7 +1498,7 @@ bool CityManager::acceptNewSolution(double energyDiff, double temperature) {
     if (energyDiff < 0) return true;
 
     // 新解更差,计算接受概率 (允许更多坏解,增加全局搜索能力)
-    return std::exp(-energyDiff / temperature) > (static_cast<double>(rand()) / RAND_MAX);
+    return std::exp(-energyDiff / temperature) > gen.uniformReal();
 }
 
 // 路径总距离计算
@@ -373,15 +1514,25 @@ double CityManager::calculateTotalDistance(const QList<City>& path) {
     return total;
 }
 
+// 按编号由坐标计算回路总距离
+double CityManager::calculateTotalDistance(const QList<int>& tour, const CityCoordinates& coords) const {
+    int n = tour.size();
+    if (n < 2) return 0.0;
+    const int *order = tour.constData();
+    double total = 0.0;
+    for (int i = 0; i < n - 1; ++i) {
+        total += coords.distance(order[i], order[i + 1]);
+    }
+    total += coords.distance(order[n - 1], order[0]);
+    return total;
+}
+
 // 模拟退火算法
-QList<City> CityManager::solveTSPWithSimulatedAnnealing(QList<AnnealingStep>* steps) {
+QList<City> CityManager::solveTSPWithSimulatedAnnealing(StepSink<AnnealingStep>* steps, bool polish) {
     QList<City> allCities = getAllCities();
     int n = allCities.size();
     if (n <= 1) return QList<City>();
 
-    // 清空历史步骤
-    if (steps) steps->clear();
-
     // 自适应参数
     double initialTemp, coolingRate;
     int iterationsPerTemp;
@@ -390,12 +1541,16 @@ QList<City> CityManager::solveTSPWithSimulatedAnnealing(QList<AnnealingStep>* st
     // 定义 终止温度,越低精度越高
     double finalTemp = 1e-4;
 
+    // 解用城市编号序列表示, 距离由坐标现算, 内存只随城市数线性增长
+    CityCoordinates coords = getCoordinates();
+    rng.seed(randomSeed);
+
     // 生成初始解
-    QList<City> currentSolution = generateInitialSolution(allCities);
-    double currentEnergy = calculateTotalDistance(currentSolution);
+    QList<int> currentSolution = generateInitialSolution(coords, rng);
+    double currentEnergy = calculateTotalDistance(currentSolution, coords);
 
     // 记录最优解
-    QList<City> bestSolution = currentSolution;
+    QList<int> bestSolution = currentSolution;
     double bestEnergy = currentEnergy;
 
     // 记录初始状态
@@ -415,23 +1570,26 @@ QList<City> CityManager::solveTSPWithSimulatedAnnealing(QList<AnnealingStep>* st
     double temperature = initialTemp;
     int iterationCount = 0; // 迭代次数
 
+    // 不超过三个城市时只有一种回路, 不需要搜索
+    if (n <= 3) temperature = finalTemp;
+
     // 模拟退火主循环
-    while (temperature > finalTemp && stagnationCount < maxStagnation) {
+    while (temperature > finalTemp && stagnationCount < maxStagnation && !isCancelled()) {
         bool improved = false;
         int acceptedCount = 0; // 记录接受次数
         int rejectedCount = 0; // 记录拒绝次数
 
         // 开始同一温度下的迭代循环
         for (int i = 0; i < iterationsPerTemp; ++i) {
-            QList<City> newSolution = generateNeighbor(currentSolution);
-            double newEnergy = calculateTotalDistance(newSolution);
-            double delta = newEnergy - currentEnergy;
+            // 只计算变化的边, 接受后才在原路径上修改
+            TourMove move = generateNeighbor(currentSolution, coords, rng);
+            double delta = move.delta;
 
-            bool accepted = acceptNewSolution(delta, temperature);
+            bool accepted = acceptNewSolution(delta, temperature, rng);
 
             if (accepted) {
-                currentSolution = newSolution;
-                currentEnergy = newEnergy;
+                applyMove(currentSolution, move);
+                currentEnergy += delta;
                 acceptedCount++;
 
                 if (currentEnergy < bestEnergy) {
@@ -440,26 +1598,32 @@ QList<City> CityManager::solveTSPWithSimulatedAnnealing(QList<AnnealingStep>* st
                     improved = true;
                     stagnationCount = 0; // 停滞次数归零
 
-                    // 记录找到新最优解
-                    if (steps) {
+                    // 记录找到新最优解, 接收端不要这一步时不格式化消息
+                    publishTour([&]() -> const QList<int>& { return bestSolution; });
+                    iterationCount++;
+                    addStep(steps, bestEnergy, [&]() {
                         AnnealingStep step;
-                        step.iteration = ++iterationCount;
+                        step.iteration = iterationCount;
                         step.temperature = temperature;
                         step.currentEnergy = currentEnergy;
                         step.bestEnergy = bestEnergy;
                         step.message = QString("找到新最优解: %1").arg(bestEnergy);
-                        steps->append(step);
-                    }
+                        return step;
+                    });
                 }
             } else {
                 rejectedCount++;
             }
         }
 
+        // 增量累加会积累舍入误差, 每个温度周期结束时重新计算一次
+        currentEnergy = calculateTotalDistance(currentSolution, coords);
+
         // 记录每个温度周期的统计信息
-        if (steps) {
+        iterationCount++;
+        addStep(steps, bestEnergy, [&]() {
             AnnealingStep step;
-            step.iteration = ++iterationCount;
+            step.iteration = iterationCount;
             step.temperature = temperature;
             step.currentEnergy = currentEnergy;
             step.bestEnergy = bestEnergy;
@@ -477,9 +1641,8 @@ QList<City> CityManager::solveTSPWithSimulatedAnnealing(QList<AnnealingStep>* st
                                    .arg(stagnationCount)
                                    .arg(maxStagnation);
             }
-
-            steps->append(step);
-        }
+            return step;
+        });
 
         if (!improved) {
             stagnationCount++;
@@ -488,6 +1651,30 @@ QList<City> CityManager::solveTSPWithSimulatedAnnealing(QList<AnnealingStep>* st
         temperature *= coolingRate; // 执行降温
     }
 
+    // 退火结果再用局部搜索收尾
+    if (polish && n >= 5 && !isCancelled()) {
+        std::vector<int> tour(bestSolution.begin(), bestSolution.end());
+        LocalSearch<> search(coords);
+        search.setCancelFlag(cancelFlag());
+        double polished = search.optimize(tour);
+        if (polished < bestEnergy) {
+            if (steps) {
+                AnnealingStep step;
+                step.iteration = ++iterationCount;
+                step.temperature = temperature;
+                step.currentEnergy = polished;
+                step.bestEnergy = polished;
+                step.message = QString("局部搜索优化: %1 -> %2 (2-opt %3 次, Or-opt %4 次)")
+                                   .arg(bestEnergy).arg(polished)
+                                   .arg(search.lastStats().twoOptMoves)
+                                   .arg(search.lastStats().orOptMoves);
+                steps->append(step);
+            }
+            bestSolution = QList<int>(tour.begin(), tour.end());
+            bestEnergy = polished;
+        }
+    }
+
     // 记录最终结果
     if (steps) {
         AnnealingStep step;
@@ -495,54 +1682,402 @@ QList<City> CityManager::solveTSPWithSimulatedAnnealing(QList<AnnealingStep>* st
         step.temperature = temperature;
         step.currentEnergy = currentEnergy;
         step.bestEnergy = bestEnergy;
-        step.message = QString("算法终止，最终最优解: %1").arg(bestEnergy);
+        step.message = QString(isCancelled() ? "已取消，目前最优解: %1" : "算法终止，最终最优解: %1").arg(bestEnergy);
         steps->append(step);
     }
 
-    return bestSolution;
+    QList<City> result;
+    result.reserve(n);
+    for (int idx : bestSolution) {
+        result.append(allCities[idx]);
+    }
+    return result;
 }
 
-// 从文件中读取城市
-bool CityManager::loadFromFile(const QString& filename) {
-    QFile file(filename);
-    // 以只读、文本模式打开文件
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return false;
+namespace {
+
+// 并行回火中的一条链, 只由执行它的线程访问
+struct TemperingChain {
+    QList<int> tour;
+    double energy = 0;
+    QList<int> best;          // 这条链到过的最短回路
+    double bestEnergy = 0;
+    Xoshiro256 gen;           // 独立的随机数流
+    qint64 accepted = 0;      // 本轮接受的移动数
+};
+
+const int SHARE_INTERVAL = 20; // 每隔多少轮把全局最优解交给最冷的链
+
+} // namespace
+
+// 并行回火模拟退火
+QList<City> CityManager::solveTSPWithParallelTempering(StepSink<AnnealingStep>* steps, int threadCount, int epochs,
+                                                        qint64 timeLimitMs, bool polish) {
+    QList<City> allCities = getAllCities();
+    int n = allCities.size();
+    if (n <= 1) return QList<City>();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    CityCoordinates coords = getCoordinates();
+    WorkStealingPool pool(threadCount);
+    int chainCount = qMax(2, pool.threadCount());
+    int movesPerEpoch = qMax(100, 10 * n);
+    epochs = qMax(1, epochs);
+
+    // 所有链从同一条初始回路出发; 之后每跳一次分出一条互不重叠的随机数流
+    Xoshiro256 stream(randomSeed);
+    QList<int> initial = generateInitialSolution(coords, stream);
+    double initialEnergy = calculateTotalDistance(initial, coords);
+
+    // 温度以平均边长为尺度: 最热的链从平均边长开始, 最冷的链低 20 倍, 整个阶梯在 epochs 轮内降到 1/100
+    double ladderRatio = std::pow(20.0, 1.0 / (chainCount - 1));
+    double coldest = initialEnergy / n / 20.0;
+    double coolingRate = std::pow(0.01, 1.0 / epochs);
+
+    std::vector<TemperingChain> chains(chainCount);
+    for (int c = 0; c < chainCount; ++c) {
+        stream.jump();
+        chains[c].gen = stream;
+        chains[c].tour = initial;
+        chains[c].energy = initialEnergy;
+        chains[c].best = initial;
+        chains[c].bestEnergy = initialEnergy;
     }
+    // slot[k]: 处在第 k 低温度上的链
+    std::vector<int> slot(chainCount);
+    for (int k = 0; k < chainCount; ++k) slot[k] = k;
+    stream.jump();
+    Xoshiro256 exchangeGen = stream;
 
-    // 清空现有城市
-    for (int i = 0; i < HASH_SIZE; ++i) {
-        Node *current = list[i];
-        while (current) {
-            Node *next = current->next;
-            delete current;
-            current = next;
-        }
-        list[i] = nullptr;
+    QList<int> bestSolution = initial;
+    double bestEnergy = initialEnergy;
+
+    if (steps) {
+        AnnealingStep step;
+        step.iteration = 0;
+        step.temperature = coldest;
+        step.currentEnergy = initialEnergy;
+        step.bestEnergy = bestEnergy;
+        step.message = QString("开始并行回火 (城市数: %1, 链数: %2, 线程数: %3, 轮数: %4, 种子: %5)")
+                           .arg(n).arg(chainCount).arg(pool.threadCount()).arg(epochs).arg(randomSeed);
+        steps->append(step);
     }
-    size = 0;
 
-    QTextStream in(&file);
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        QStringList parts = line.split(QRegularExpression("\\s+")); // 按空白字符分割成多个子字符串
+    // 不超过三个城市时只有一种回路, 不需要搜索
+    if (n <= 3) epochs = 0;
+
+    int epoch = 0;
+    for (; epoch < epochs; ++epoch) {
+        if (timeLimitMs > 0 && timer.elapsed() >= timeLimitMs) break;
+        if (isCancelled()) break;
+
+        // 各链在自己的温度上独立退火, 坐标只读共享
+        pool.run(chainCount, [&](int k, int) {
+            TemperingChain &chain = chains[slot[k]];
+            double temperature = coldest * std::pow(ladderRatio, k);
+            chain.accepted = 0;
+            for (int i = 0; i < movesPerEpoch; ++i) {
+                TourMove move = generateNeighbor(chain.tour, coords, chain.gen);
+                if (!acceptNewSolution(move.delta, temperature, chain.gen)) continue;
+                applyMove(chain.tour, move);
+                chain.energy += move.delta;
+                chain.accepted++;
+                if (chain.energy < chain.bestEnergy) {
+                    chain.best = chain.tour;
+                    chain.bestEnergy = chain.energy;
+                }
+            }
+            chain.energy = calculateTotalDistance(chain.tour, coords);
+        });
 
-        if (parts.size() >= 3) {
-            City city;
-            city.name = parts[0];
-            city.x = parts[1].toDouble();
-            city.y = parts[2].toDouble();
+        // 按链的编号顺序汇总, 结果与线程调度无关
+        bool improved = false;
+        for (const TemperingChain &chain : chains) {
+            if (chain.bestEnergy < bestEnergy) {
+                double exact = calculateTotalDistance(chain.best, coords);
+                if (exact < bestEnergy) {
+                    bestSolution = chain.best;
+                    bestEnergy = exact;
+                    improved = true;
+                }
+            }
+        }
 
-            addCity(city);
+        // 相邻温度的链交换温度, 奇偶轮交替配对
+        int swaps = 0;
+        int attempts = 0;
+        for (int k = epoch % 2; k + 1 < chainCount; k += 2) {
+            double colderT = coldest * std::pow(ladderRatio, k);
+            double hotterT = colderT * ladderRatio;
+            double exponent = (1 / colderT - 1 / hotterT) * (chains[slot[k]].energy - chains[slot[k + 1]].energy);
+            attempts++;
+            if (exponent >= 0 || exchangeGen.uniformReal() < std::exp(exponent)) {
+                std::swap(slot[k], slot[k + 1]);
+                swaps++;
+            }
         }
+
+        // 最冷的链定期从全局最优解继续
+        if ((epoch + 1) % SHARE_INTERVAL == 0 && chains[slot[0]].energy > bestEnergy) {
+            chains[slot[0]].tour = bestSolution;
+            chains[slot[0]].energy = bestEnergy;
+        }
+
+        publishTour([&]() -> const QList<int>& { return bestSolution; });
+        addStep(steps, bestEnergy, [&]() {
+            AnnealingStep step;
+            step.iteration = epoch + 1;
+            step.temperature = coldest;
+            step.currentEnergy = chains[slot[0]].energy;
+            step.bestEnergy = bestEnergy;
+            step.message = QString("第 %1 轮%2: 最冷链接受 %3 次, 温度交换 %4/%5")
+                               .arg(epoch + 1).arg(improved ? ", 找到更优解" : "")
+                               .arg(chains[slot[0]].accepted).arg(swaps).arg(attempts);
+            return step;
+        });
+
+        coldest *= coolingRate;
     }
 
-    file.close();
+    // 结果再用局部搜索收尾
+    if (polish && n >= 5 && !isCancelled()) {
+        std::vector<int> tour(bestSolution.begin(), bestSolution.end());
+        LocalSearch<> search(coords);
+        search.setCancelFlag(cancelFlag());
+        double polished = search.optimize(tour);
+        if (polished < bestEnergy) {
+            if (steps) {
+                AnnealingStep step;
+                step.iteration = epoch + 1;
+                step.temperature = coldest;
+                step.currentEnergy = polished;
+                step.bestEnergy = polished;
+                step.message = QString("局部搜索优化: %1 -> %2 (2-opt %3 次, Or-opt %4 次)")
+                                   .arg(bestEnergy).arg(polished)
+                                   .arg(search.lastStats().twoOptMoves)
+                                   .arg(search.lastStats().orOptMoves);
+                steps->append(step);
+            }
+            bestSolution = QList<int>(tour.begin(), tour.end());
+            bestEnergy = polished;
+        }
+    }
+
+    if (steps) {
+        AnnealingStep step;
+        step.iteration = epoch + 1;
+        step.temperature = coldest;
+        step.currentEnergy = bestEnergy;
+        step.bestEnergy = bestEnergy;
+        step.message = QString(isCancelled() ? "并行回火已取消: %1 轮, 用时 %2 ms, 目前最优解: %3"
+                                             : "并行回火结束: %1 轮, 用时 %2 ms, 最优解: %3")
+                           .arg(epoch).arg(timer.elapsed()).arg(bestEnergy);
+        steps->append(step);
+    }
+
+    QList<City> result;
+    result.reserve(n);
+    for (int idx : bestSolution) {
+        result.append(allCities[idx]);
+    }
+    return result;
+}
+
+/***************************遗传算法********************************/
+
+// 岛屿模型遗传算法
+QList<City> CityManager::solveTSPWithGeneticAlgorithm(StepSink<GeneticStep>* steps, GeneticAlgorithm::Crossover crossover,
+                                                      int threadCount, int generations, qint64 timeLimitMs) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    QList<City> cityList = getAllCities();
+    CityCoordinates coords = getCoordinates();
+    GeneticAlgorithm ga(coords, threadCount);
+    ga.setCrossover(crossover);
+    ga.setGenerations(generations);
+    ga.setTimeLimit(timeLimitMs);
+    ga.setSeed(randomSeed);
+    ga.setCancelFlag(cancelFlag());
+
+    if (steps) {
+        GeneticStep step;
+        step.generation = 0;
+        step.bestDistance = 0;
+        step.averageDistance = 0;
+        step.message = QString("开始遗传算法 (城市数: %1, %2, 岛数: %3, 线程数: %4, 种子: %5)")
+                           .arg(n).arg(GeneticAlgorithm::crossoverName(crossover))
+                           .arg(ga.islandCount()).arg(ga.threadCount()).arg(randomSeed);
+        steps->append(step);
+    }
+
+    ga.setProgressCallback([this, steps](const GeneticAlgorithm::Progress &progress) {
+        if (progress.tour) publishTour([&]() -> const std::vector<int>& { return *progress.tour; });
+        addStep(steps, progress.bestLength, [&]() {
+            GeneticStep step;
+            step.generation = progress.generation;
+            step.bestDistance = progress.bestLength;
+            step.averageDistance = progress.averageLength;
+            step.message = QString("%1第 %2 次迁移, 已收敛的岛 %3 个, 用时 %4 ms")
+                               .arg(progress.improved ? "找到更优解; " : "")
+                               .arg(progress.migrations)
+                               .arg(progress.convergedIslands)
+                               .arg(progress.elapsedMs);
+            return step;
+        });
+    });
+
+    std::vector<int> tour = ga.solve();
+    result = buildPathFromIndices(cityList, QList<int>(tour.begin(), tour.end()));
+
+    if (steps) {
+        const GeneticAlgorithm::Progress &progress = ga.lastProgress();
+        GeneticStep step;
+        step.generation = progress.generation;
+        step.bestDistance = progress.bestLength;
+        step.averageDistance = progress.averageLength;
+        step.message = QString(isCancelled() ? "遗传算法已取消: %1 代, 用时 %2 ms, 目前最优解: %3"
+                                             : "遗传算法结束: %1 代, 用时 %2 ms, 最优解: %3")
+                           .arg(progress.generation).arg(progress.elapsedMs).arg(progress.bestLength, 0, 'f', 3);
+        steps->append(step);
+    }
+
+    return result;
+}
+
+/***************************蚁群算法********************************/
+
+// MAX-MIN 蚁群算法
+QList<City> CityManager::solveTSPWithAntColony(StepSink<AntColonyStep>* steps, int threadCount, int iterations,
+                                               qint64 timeLimitMs, int logInterval) const {
+    QList<City> result;
+    int n = getCityCount();
+    if (n < 2) return result;
+
+    QList<City> cityList = getAllCities();
+    CityCoordinates coords = getCoordinates();
+    AntColony colony(coords, 12, threadCount);
+    colony.setIterations(iterations);
+    colony.setTimeLimit(timeLimitMs);
+    colony.setSeed(randomSeed);
+    colony.setCancelFlag(cancelFlag());
+
+    if (steps) {
+        AntColonyStep step;
+        step.iteration = 0;
+        step.iterationBest = 0;
+        step.bestDistance = 0;
+        step.tauMin = 0;
+        step.tauMax = 0;
+        step.message = QString("开始蚁群算法 (城市数: %1, 蚂蚁数: %2, 线程数: %3, 种子: %4)")
+                           .arg(n).arg(colony.ants()).arg(colony.threadCount()).arg(randomSeed);
+        steps->append(step);
+    }
+
+    logInterval = qMax(1, logInterval);
+    colony.setProgressCallback([this, steps, logInterval](const AntColony::Progress &progress) {
+        publishProgress(progress.bestLength, QString("第 %1 轮, 本轮最优 %2")
+                                                 .arg(progress.iteration)
+                                                 .arg(progress.iterationBest, 0, 'f', 3));
+        if (progress.tour) publishTour([&]() -> const std::vector<int>& { return *progress.tour; });
+        if (!steps || (!progress.improved && progress.iteration % logInterval != 0)) return;
+        steps->add([&]() {
+            AntColonyStep step;
+            step.iteration = progress.iteration;
+            step.iterationBest = progress.iterationBest;
+            step.bestDistance = progress.bestLength;
+            step.tauMin = progress.tauMin;
+            step.tauMax = progress.tauMax;
+            step.message = QString("%1本轮平均 %2, 用时 %3 ms%4")
+                               .arg(progress.improved ? "找到更优解; " : "")
+                               .arg(progress.iterationMean, 0, 'f', 3)
+                               .arg(progress.elapsedMs)
+                               .arg(progress.restarts > 0 ? QString(", 已重置信息素 %1 次").arg(progress.restarts)
+                                                          : QString());
+            return step;
+        });
+    });
+
+    std::vector<int> tour = colony.solve();
+    result = buildPathFromIndices(cityList, QList<int>(tour.begin(), tour.end()));
+
+    if (steps) {
+        const AntColony::Progress &progress = colony.lastProgress();
+        AntColonyStep step;
+        step.iteration = progress.iteration;
+        step.iterationBest = progress.iterationBest;
+        step.bestDistance = progress.bestLength;
+        step.tauMin = progress.tauMin;
+        step.tauMax = progress.tauMax;
+        step.message = QString(isCancelled() ? "蚁群算法已取消: %1 轮, 用时 %2 ms, 目前最优解: %3"
+                                             : "蚁群算法结束: %1 轮, 用时 %2 ms, 最优解: %3")
+                           .arg(progress.iteration).arg(progress.elapsedMs).arg(progress.bestLength, 0, 'f', 3);
+        steps->append(step);
+    }
+
+    return result;
+}
+
+// 从文件中读取城市: 并行解析后按文件顺序批量插入, 空间网格最后一次建好
+bool CityManager::loadFromFile(const QString& filename, CityFileReport* report) {
+    QElapsedTimer timer;
+    timer.start();
+
+    CityFileParser parser;
+    if (!parser.parseFile(filename)) {
+        return false;
+    }
+
+    // 清空现有城市
+    clearAll();
+    reserve(static_cast<int>(parser.entryCount()));
+
+    CityFileReport result;
+    result.lineCount = parser.lineCount();
+    QList<SpatialGrid::Entry> points;
+    points.reserve(parser.entryCount());
+    for (const CityFileParser::Chunk& chunk : parser.chunks()) {
+        result.issueCounts[CityFileIssue::MissingFields] += chunk.issueCounts[CityFileIssue::MissingFields];
+        result.issueCounts[CityFileIssue::InvalidNumber] += chunk.issueCounts[CityFileIssue::InvalidNumber];
+        for (const CityFileIssue& issue : chunk.issues) {
+            result.issues.append(issue);
+        }
+
+        const QChar* names = chunk.names.constData();
+        for (const CityFileParser::Entry& entry : chunk.entries) {
+            QStringView name(names + entry.nameOffset, entry.nameLength);
+            int id = insertRecord(name, entry.x, entry.y);
+            if (id >= 0) {
+                points.append({entry.x, entry.y, id});
+            } else if (result.issueCounts[CityFileIssue::DuplicateName]++ < CityFileReport::MAX_ISSUES) {
+                // 重名按行号顺序发现, 只保留前 MAX_ISSUES 条
+                result.issues.append(CityFileIssue{chunk.firstLine + entry.line, CityFileIssue::DuplicateName,
+                                                   QString("%1 %2 %3").arg(name).arg(entry.x).arg(entry.y)});
+            }
+        }
+    }
+    grid.build(points);
+
+    if (report) {
+        // 合并两类问题, 按行号取前 MAX_ISSUES 条
+        std::stable_sort(result.issues.begin(), result.issues.end(),
+                         [](const CityFileIssue& a, const CityFileIssue& b) { return a.line < b.line; });
+        if (result.issues.size() > CityFileReport::MAX_ISSUES) {
+            result.issues.resize(CityFileReport::MAX_ISSUES);
+        }
+        result.cityCount = size;
+        result.elapsedMs = timer.elapsed();
+        *report = std::move(result);
+    }
     return true;
 }
 
 // 保存城市列表到文件
-bool CityManager::saveToFile(const QString& filename) const {
+bool CityManager::saveToFile(const QString& filename) {
+    detachIfMapped(filename);
     QFile file(filename);
     // 以只写文本的方式打开文件
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -551,11 +2086,71 @@ bool CityManager::saveToFile(const QString& filename) const {
 
     QTextStream out(&file);
     QList<City> allCities = getAllCities();
+    // 坐标按能精确读回的最短形式输出, 与数据库文件互相转换时不损失精度
     Q_FOREACH(const auto& city, allCities) {
         out << city.name << " "
-            << city.x << " " << city.y << "\n";
+            << QString::number(city.x, 'g', QLocale::FloatingPointShortest) << " "
+            << QString::number(city.y, 'g', QLocale::FloatingPointShortest) << "\n";
     }
 
     file.close();
     return true;
 }
+
+// 打开数据库文件: 先在新对象上映射并检查, 成功后才替换现有城市
+bool CityManager::openDatabase(const QString& filename, QString* error) {
+    std::unique_ptr<CityDatabase> opened(new CityDatabase);
+    if (!opened->open(filename, error)) {
+        return false;
+    }
+    clearAll();
+    database = std::move(opened);
+    size = database->size();
+    return true;
+}
+
+// 保存为数据库文件, 名称直接引用内存池或已打开的数据库, 不复制成 QString
+bool CityManager::saveDatabase(const QString& filename, QString* error) {
+    bool remap = detachIfMapped(filename);
+    QList<QStringView> names;
+    names.reserve(size);
+    if (database) {
+        for (int id = 0; id < database->size(); ++id) {
+            names.append(database->name(id));
+        }
+    } else {
+        for (int id = 0; id < pool.capacity(); ++id) {
+            if (pool.at(id).name) {
+                names.append(nameOf(id));
+            }
+        }
+    }
+    if (!CityDatabase::write(filename, names, getCoordinates(), error)) {
+        return false;
+    }
+    // 原来就是映射方式打开的, 改为映射新文件, 释放刚复制到内存中的城市
+    if (remap) {
+        openDatabase(filename);
+    }
+    return true;
+}
+
+// 文本与数据库文件互相转换
+bool CityManager::convertFile(const QString& input, const QString& output, QString* error) {
+    CityManager manager;
+    if (input.endsWith(".tspdb", Qt::CaseInsensitive)) {
+        if (!manager.openDatabase(input, error)) return false;
+    } else if (!manager.loadFromFile(input)) {
+        if (error) *error = QString("无法打开文件: %1").arg(input);
+        return false;
+    }
+
+    if (output.endsWith(".tspdb", Qt::CaseInsensitive)) {
+        return manager.saveDatabase(output, error);
+    }
+    if (!manager.saveToFile(output)) {
+        if (error) *error = QString("无法写入文件: %1").arg(output);
+        return false;
+    }
+    return true;
+}
@@ -3,8 +3,19 @@
 
 #include <QList>
 #include <QString>
+#include <QStringView>
 #include <cmath>
-#include <random>
+#include <memory>
+#include "citydatabase.h"
+#include "cityfileparser.h"
+#include "citypool.h"
+#include "spatialgrid.h"
+#include "distancematrix.h"
+#include "geneticalgorithm.h"
+#include "solvercontrol.h"
+#include "stepsink.h"
+#include "tourconstruction.h"
+#include "xoshiro256.h"
 
 struct City {
     QString name;
@@ -19,14 +30,70 @@ struct City {
 
 // 穷举法步骤信息
 struct BruteForceStep {
-    int iteration;            // 当前迭代次数
-    QList<City> currentPath;  // 当前路径
+    qint64 iteration;         // 当前迭代次数
+    QList<City> currentPath;  // 最优路径, 只有最后一步携带
     double currentDistance;   // 当前路径距离
     double bestDistance;      // 已知最优距离
-    int totalPermutations=0; // 需要穷举的总次数
+    long long totalPermutations=0; // 需要穷举的总次数
     QString message;          // 步骤描述
 };
 
+// 动态规划(Held-Karp)步骤信息
+struct HeldKarpStep {
+    qint64 processedSubsets;  // 已处理的子集数
+    qint64 totalSubsets;      // 子集总数
+    qint64 memoryBytes;       // 动态规划表占用内存(字节)
+    double bestDistance;      // 最优距离(求解完成后有效)
+    QString message;          // 步骤描述
+};
+
+// 分支定界步骤信息
+struct BranchAndBoundStep {
+    qint64 nodes;          // 已处理的搜索树节点数
+    double nodesPerSecond; // 每秒处理的节点数
+    double lowerBound;     // 全局下界
+    double upperBound;     // 当前最优回路长度
+    double gap;            // 上下界的相对差距
+    QString message;       // 步骤描述
+};
+
+// Christofides 步骤信息
+struct ChristofidesStep {
+    double lowerBound;     // 最小生成树权重(最优回路长度的下界, 生成树精确时有效)
+    double distance;       // 当前回路长度
+    qint64 elapsedMs;      // 用时(毫秒)
+    QString message;       // 步骤描述
+};
+
+// 局部搜索步骤信息
+struct LocalSearchStep {
+    qint64 twoOptMoves;    // 已执行的 2-opt 次数
+    qint64 orOptMoves;     // 已执行的 Or-opt 次数
+    double distance;       // 当前回路长度
+    qint64 elapsedMs;      // 用时(毫秒)
+    QString message;       // 步骤描述
+};
+
+// Lin-Kernighan 步骤信息
+struct LinKernighanStep {
+    qint64 kicks;          // 已尝试的扰动次数
+    qint64 improvements;   // 使回路变短的扰动次数
+    double distance;       // 当前回路长度
+    qint64 elapsedMs;      // 用时(毫秒)
+    QString message;       // 步骤描述
+};
+
+// 模拟退火的邻域操作, 按路径上的位置描述, 只记录变化的边带来的长度增量
+struct TourMove {
+    enum Type { Swap, TwoOpt, OrOpt };
+    Type type;
+    int i;          // 交换: 两个位置 i < j; 2-opt: 翻转位置 i..j; or-opt: 片段起点
+    int j;          // or-opt: 片段插入到位置 j 与 j+1 之间
+    int length;     // or-opt 移动的片段长度(1~3)
+    bool reversed;  // or-opt 插入时是否翻转片段
+    double delta;   // 路径长度的变化量
+};
+
 // 记录模拟退火算法日志
 struct AnnealingStep {
     int iteration;        // 当前迭代次数
@@ -36,36 +103,126 @@ struct AnnealingStep {
     QString message;      // 步骤描述
 };
 
+// 蚁群算法步骤信息
+struct AntColonyStep {
+    int iteration;        // 当前轮数
+    double iterationBest; // 本轮最优路径长度
+    double bestDistance;  // 历史最优路径长度
+    double tauMin;        // 信息素下限
+    double tauMax;        // 信息素上限
+    QString message;      // 步骤描述
+};
+
+// 遗传算法步骤信息
+struct GeneticStep {
+    int generation;         // 当前代数
+    double bestDistance;    // 最优个体的路径长度
+    double averageDistance; // 所有个体的平均路径长度
+    QString message;        // 步骤描述
+};
+
 class CityManager {
 protected:
     int size = 0; // 城市数量
-    static const int HASH_SIZE = 100; // 哈希表大小
+    static const int MIN_CAPACITY = 16; // 哈希表最小容量(2的幂)
 
-    // 拉链法解决哈希冲突
-    struct Node {
-        City city;
-        Node *next{};
+    // 城市记录存放在内存池中, 哈希表只保存记录编号
+    CityPool pool;
 
-        Node(const City &c) : city(c) {
-        }
+    // 空间网格索引, 与内存池同步维护, 用于范围查询
+    SpatialGrid grid;
+
+    // 开放定址法(线性探测)的槽位, id 为 -1 表示空槽
+    // 保存完整的32位哈希值, 探测时先比较哈希值, 相同才比较字符串
+    struct Slot {
+        quint32 hash = 0;
+        int id = -1;
     };
 
-    // 哈希表数组
-    Node *list[HASH_SIZE] = {};
+    // 哈希表数组, 容量始终是2的幂, 用位与代替求余
+    QList<Slot> hashSlots;
+    int mask = 0; // 容量 - 1
+
+    // 字符串哈希, 与数据库文件中的哈希索引相同
+    static quint32 hash(QStringView name) {
+        return CityDatabase::hash(name);
+    }
+
+    // 打开的城市数据库文件; 不为空时城市数据直接从映射中读取, 内存池和哈希表为空,
+    // 第一次增删城市前才把全部城市复制到内存池(见 detachDatabase)
+    std::unique_ptr<CityDatabase> database;
+
+    // 把数据库中的城市复制到内存池、哈希表和空间网格, 然后关闭数据库
+    void detachDatabase();
+
+    // filename 就是已打开的数据库文件时先 detachDatabase(), 映射期间不能覆盖该文件(Windows 上会失败)
+    bool detachIfMapped(const QString& filename);
+
+    // 查找名称所在的槽位下标, 不存在返回 -1
+    int findSlot(QStringView name, quint32 h) const;
+
+    // 扩容并重新散列所有节点
+    void rehash(int newCapacity);
+
+    // 清空所有城市(并关闭数据库), 内存池和哈希表的容量都保留下来复用
+    void clearAll();
 
-    // 哈希值用城市名称的ASCII的码和求余数
-    int hash(const QString &name) const {
-        int sum = 0;
-        Q_FOREACH (QChar c, name) {
-            sum += c.unicode();
-        }
-        return sum % HASH_SIZE;
+    // 把城市记录放入内存池和哈希表(不更新空间网格), 返回记录编号, 重名时返回 -1
+    int insertRecord(QStringView name, double x, double y);
+
+    // 预留至少能放下 count 个城市的哈希表容量, 批量插入时不再逐步扩容
+    void reserve(int count);
+
+    // 记录的名称
+    QStringView nameOf(int id) const {
+        const CityPool::Record &record = pool.at(id);
+        return QStringView(record.name, record.nameLength);
     }
 
+    // 由记录构造 City
+    City cityAt(int id) const {
+        const CityPool::Record &record = pool.at(id);
+        return {QString(record.name, record.nameLength), record.x, record.y};
+    }
+
+
+    // Held-Karp 内存上限, 默认 2GB
+    qint64 heldKarpMemoryLimit = 2LL * 1024 * 1024 * 1024;
 
-    // 模拟退火需要的随机数生成器
-    std::random_device rd;
-    std::mt19937 rng;
+    // 随机算法的种子, 每次求解前用它重置随机数生成器, 同一种子和同一组城市得到同一结果
+    quint64 randomSeed;
+    Xoshiro256 rng;
+
+    // 模拟退火和并行回火的初始回路构造方法
+    TourConstruction::Method initialTourMethod = TourConstruction::NearestNeighbor;
+
+    // 求解控制块, 见 setSolverControl()
+    SolverControl* solverControl = nullptr;
+
+    bool isCancelled() const { return solverControl && solverControl->isCancelled(); }
+    const std::atomic<bool>* cancelFlag() const { return solverControl ? solverControl->cancelFlag() : nullptr; }
+
+    // 向界面发布进度, 没有控制块时什么也不做
+    void publishProgress(double distance, const QString& message) const {
+        if (solverControl) solverControl->publish(distance, message);
+    }
+
+    // 发布当前最优回路(城市编号序列)供地图实时显示; 每帧最多一次, 没到时间时不调用 order
+    template <typename Order>
+    void publishTour(Order&& order) const {
+        if (solverControl && solverControl->tourDue()) solverControl->publishTour(order());
+    }
+
+    // 记录常规步骤: 接收端要这一步时才调用 make 构造步骤(包括格式化消息), 同时把它作为最新进度发布
+    template <typename Step, typename Make>
+    void addStep(StepSink<Step>* steps, double distance, Make&& make) const {
+        if (!steps) return;
+        steps->add([&]() {
+            Step step = make();
+            publishProgress(distance, step.message);
+            return step;
+        });
+    }
 
 public:
     CityManager();
@@ -86,49 +243,158 @@ public:
     // 城市数量
     int getCityCount() const;
 
+    // 内存池分配统计
+    const CityPool::Stats &getPoolStats() const;
+
     // 所有城市
     QList<City> getAllCities() const;
 
+    // 所有城市的坐标数组, 顺序与 getAllCities() 一致, 求解器据此建立距离矩阵
+    CityCoordinates getCoordinates() const;
+
     // 找出与指定城市距离在给定范围内的所有城市
     QList<City> getCitiesWithinRange(const QString& targetCityName, double range) const;
 
+    // 设置求解控制块(由调用方持有, 求解期间保持有效), 为空时求解器不检查取消也不发布进度;
+    // 设置后各求解器在循环中检查取消标志, 取消时尽快返回目前找到的最优路径(Held-Karp 没有中间解, 返回空路径),
+    // 记录步骤的同时把最新进度发布到控制块. 求解在其他线程进行时, 不能同时修改城市
+    void setSolverControl(SolverControl* control);
+    SolverControl* getSolverControl() const;
+
     /****************穷举法求解旅行商问题起点************/
 
-    // 计算阶乘
+    // 计算阶乘, 超出 long long 时饱和为最大值
     long long factorial(int n) const;
 
+    // 排列数的文字, 饱和值显示为 "> 9.2e18"
+    static QString permutationCountText(long long count);
+
     // 根据索引列表构建路径
     QList<City> buildPathFromIndices(const QList<City>& cityList, const QList<int>& indices) const;
 
     // 穷举法求解旅行商问题
-    QList<City> solveTSP(QList<BruteForceStep>* steps) const;
+    QList<City> solveTSP(StepSink<BruteForceStep>* steps) const;
+
+    // 多线程穷举: 按排列前缀划分任务交给工作窃取线程池, 线程间用原子变量共享当前最优距离剪枝
+    // 结果与单线程 solveTSP 完全一致, threadCount <= 0 时使用全部核心
+    QList<City> solveTSPParallel(StepSink<BruteForceStep>* steps, int threadCount = 0) const;
+
+    // 剪枝穷举: 固定起点并去掉镜像路线, 只需考察 (n-1)!/2 条回路;
+    // 深度优先搜索时累加部分路径长度, 部分长度加下界不小于当前最优时剪掉整棵子树
+    QList<City> solveTSPWithPruning(StepSink<BruteForceStep>* steps) const;
+
+    /****************动态规划(Held-Karp)起点************/
+
+    // 估算 Held-Karp 动态规划表需要的内存(字节)
+    static qint64 estimateHeldKarpMemory(int cityCount);
+
+    // 设置/获取 Held-Karp 允许使用的内存上限(字节)
+    void setHeldKarpMemoryLimit(qint64 bytes);
+    qint64 getHeldKarpMemoryLimit() const;
+
+    // 状态压缩动态规划求解旅行商问题, O(n²·2ⁿ), 内存超过上限时拒绝求解并返回空路径
+    QList<City> solveTSPWithHeldKarp(StepSink<HeldKarpStep>* steps) const;
+
+    /****************分支定界起点************/
+
+    // 分支定界求解旅行商问题: Held-Karp 1-tree 下界 + 次梯度优化, 最近邻加 2-opt 回路作为初始上界
+    // 适合 30~60 个城市; timeLimitMs > 0 时超时返回当前最优回路, 日志中的差距说明离最优还有多远
+    QList<City> solveTSPWithBranchAndBound(StepSink<BranchAndBoundStep>* steps, qint64 timeLimitMs = 60000) const;
+
+    /****************Christofides起点************/
+
+    // Christofides 算法: 最小生成树 + 奇度顶点匹配 + 欧拉回路抄近路, 匹配精确时不超过最优解的 1.5 倍
+    // 不需要距离矩阵, 十万个城市一秒左右; polish 为 true 时再用 2-opt/Or-opt 局部搜索改进
+    QList<City> solveTSPWithChristofides(StepSink<ChristofidesStep>* steps, bool polish = true) const;
+
+    /****************局部搜索起点************/
+
+    // 最近邻回路 + 2-opt/Or-opt 局部搜索, 只考察每个城市的 k 个最近邻居, 上万个城市也能很快收敛
+    QList<City> solveTSPWithLocalSearch(StepSink<LocalSearchStep>* steps, int neighborCount = 10) const;
+
+    /****************Lin-Kernighan起点************/
+
+    // 链式 Lin-Kernighan: 变深度搜索到局部最优后不断做局部双桥扰动, 直到 timeLimitMs 用完
+    // 五千个城市以上改用两级链表表示回路, 百万个城市也能在一分钟内到达 LK 局部最优; 进度按 progressIntervalMs 的间隔记入日志
+    QList<City> solveTSPWithLinKernighan(StepSink<LinKernighanStep>* steps, qint64 timeLimitMs = 30000,
+                                         qint64 progressIntervalMs = 1000) const;
 
     /****************模拟退火算法起点********************/
-    // 模拟退火算法求解旅行商问题
-    QList<City> solveTSPWithSimulatedAnnealing(QList<AnnealingStep>* steps);
+    // 设置/获取随机种子, 模拟退火、并行回火和 Lin-Kernighan 的扰动都由它决定; 默认在构造时随机生成
+    void setRandomSeed(quint64 seed);
+    quint64 getRandomSeed() const;
+
+    // 设置/获取模拟退火和并行回火的初始回路构造方法, 默认最近邻(起点随机)
+    void setInitialTourMethod(TourConstruction::Method method);
+    TourConstruction::Method getInitialTourMethod() const;
+
+    // 模拟退火算法求解旅行商问题, polish 为 true 时最后用局部搜索把最优解改进到局部最优
+    QList<City> solveTSPWithSimulatedAnnealing(StepSink<AnnealingStep>* steps, bool polish = true);
+
+    // 并行回火: 每条链一个温度, 温度按等比阶梯排列并整体降温, 各链在线程池上并行退火 epochs 轮;
+    // 每轮结束后相邻温度的链按 Metropolis 准则交换温度, 最冷的链定期从全局最优解继续;
+    // 链数等于线程数(至少 2), 各链的随机数流由种子 jump() 分出, 种子、线程数和轮数相同时结果可重现, 与线程调度无关;
+    // timeLimitMs > 0 时到时提前结束, 此时结果取决于机器速度
+    QList<City> solveTSPWithParallelTempering(StepSink<AnnealingStep>* steps, int threadCount = 0, int epochs = 500,
+                                              qint64 timeLimitMs = 0, bool polish = true);
+
+    // 按 initialTourMethod 生成初始解(城市编号序列), 最近邻法的起点由 gen 随机选择
+    QList<int> generateInitialSolution(const CityCoordinates& coords, Xoshiro256& gen) const;
 
-    // 生成初始解
-    QList<City> generateInitialSolution(const QList<City>& cities);
+    // 随机生成交换/2-opt/or-opt 邻域操作, 由坐标 O(1) 计算长度增量, 不修改路径
+    TourMove generateNeighbor(const QList<int>& tour, const CityCoordinates& coords, Xoshiro256& gen) const;
 
-    // 2-opt优化
-    QList<City> generateNeighbor(const QList<City>& solution);
+    // 在原路径上执行邻域操作, 翻转和平移都选较短的一侧
+    void applyMove(QList<int>& tour, const TourMove& move) const;
 
     // 根据城市数量自适应调整参数
     void adjustParameters(int cityCount, double& initialTemp, double& coolingRate, int& iterationsPerTemp);
 
     // 接受程度计算
-    bool acceptNewSolution(double energyDiff, double temperature);
+    bool acceptNewSolution(double energyDiff, double temperature, Xoshiro256& gen) const;
 
     // 路径总距离计算
     double calculateTotalDistance(const QList<City>& path);
 
+    // 按城市编号由坐标计算回路总距离
+    double calculateTotalDistance(const QList<int>& tour, const CityCoordinates& coords) const;
+
     /****************模拟退火算法终点********************/
 
-    // 从文件中加载
-    bool loadFromFile(const QString& filename);
+    /****************遗传算法起点********************/
+
+    // 岛屿模型遗传算法: 每个线程一个岛(至少 2 个), 个体为城市编号数组, 每隔若干代把各岛的最优个体迁移到下一个岛;
+    // 岛的随机数流由 randomSeed 分出, 种子、线程数和代数相同时结果可重现;
+    // generations 代或 timeLimitMs 毫秒(大于 0 时)先到为准, 所有岛都收敛时提前结束
+    QList<City> solveTSPWithGeneticAlgorithm(StepSink<GeneticStep>* steps,
+                                             GeneticAlgorithm::Crossover crossover = GeneticAlgorithm::EdgeAssembly,
+                                             int threadCount = 0, int generations = 1000,
+                                             qint64 timeLimitMs = 30000) const;
+
+    /****************蚁群算法起点********************/
+
+    // MAX-MIN 蚁群算法: 信息素只保存在候选边上, 每轮所有蚂蚁在线程池上并行构造回路并做局部搜索;
+    // 蚂蚁的随机数流由 randomSeed 分出, 种子和轮数相同时结果可重现, 与线程数无关;
+    // iterations 轮或 timeLimitMs 毫秒(大于 0 时)先到为准, 每 logInterval 轮和找到更优解时记一条日志
+    QList<City> solveTSPWithAntColony(StepSink<AntColonyStep>* steps, int threadCount = 0, int iterations = 1000,
+                                      qint64 timeLimitMs = 30000, int logInterval = 20) const;
+
+    // 从文件中加载, 替换现有城市; 文件无法打开时返回 false
+    // 有问题的行(字段不足、坐标无效、重名)跳过, 明细写入 report(可为空)
+    bool loadFromFile(const QString& filename, CityFileReport* report = nullptr);
 
     // 保存到文件
-    bool saveToFile(const QString& filename) const;
+    bool saveToFile(const QString& filename);
+
+    // 打开城市数据库文件(.tspdb), 替换现有城市; 只映射文件, 城市数与打开用时无关
+    // 打开失败时保留现有城市, 返回 false 并在 error 中说明原因
+    bool openDatabase(const QString& filename, QString* error = nullptr);
+
+    // 把当前城市写成数据库文件; 目标是已打开的数据库时, 先复制到内存再写, 写完重新映射新文件
+    bool saveDatabase(const QString& filename, QString* error = nullptr);
+
+    // 在文本文件和数据库文件之间转换, 按输出文件的扩展名(.tspdb)决定方向
+    static bool convertFile(const QString& input, const QString& output, QString* error = nullptr);
 
 
 };
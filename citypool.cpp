@@ -0,0 +1,104 @@
+#include "citypool.h"
+#include <cstring>
+
+CityPool::CityPool() {
+}
+
+CityPool::~CityPool() {
+    releaseMemory();
+}
+
+// 分配一条城市记录
+int CityPool::allocate(QStringView name, double x, double y) {
+    int id;
+    if (freeHead >= 0) {
+        // 优先复用被删除城市留下的记录
+        id = freeHead;
+        freeHead = at(id).nextFree;
+        counters.recordReuses++;
+    } else {
+        // 当前记录 slab 用完时才向系统申请新块
+        if (recordCount == recordSlabs.size() * RECORDS_PER_SLAB) {
+            recordSlabs.append(new Record[RECORDS_PER_SLAB]);
+            counters.slabAllocations++;
+            counters.slabBytes += sizeof(Record) * RECORDS_PER_SLAB;
+        }
+        id = recordCount++;
+    }
+
+    Record &record = at(id);
+    QChar *chars = allocateChars(static_cast<int>(name.size()));
+    if (!name.isEmpty()) {
+        std::memcpy(chars, name.data(), sizeof(QChar) * name.size());
+    }
+    record.x = x;
+    record.y = y;
+    record.name = chars;
+    record.nameLength = static_cast<int>(name.size());
+    record.nextFree = -1;
+    counters.recordAllocations++;
+    return id;
+}
+
+// 释放记录
+void CityPool::release(int id) {
+    Record &record = at(id);
+    record.name = nullptr;
+    record.nameLength = 0;
+    record.nextFree = freeHead;
+    freeHead = id;
+}
+
+// 切分名称字符, 名称长度为 0 时也返回一个有效地址, 以区分"已释放"
+QChar *CityPool::allocateChars(int length) {
+    int needed = qMax(length, 1);
+    while (charSlabIndex < charSlabs.size()) {
+        CharSlab &slab = charSlabs[charSlabIndex];
+        if (slab.capacity - charOffset >= needed) {
+            QChar *result = slab.data + charOffset;
+            charOffset += needed;
+            return result;
+        }
+        // 当前块剩余空间不够, 换下一块
+        charSlabIndex++;
+        charOffset = 0;
+    }
+
+    // 已有的块都用完了, 申请新块(超长名称单独占一块)
+    CharSlab slab;
+    slab.capacity = qMax(needed, static_cast<int>(CHARS_PER_SLAB));
+    slab.data = new QChar[slab.capacity];
+    charSlabs.append(slab);
+    counters.slabAllocations++;
+    counters.slabBytes += sizeof(QChar) * slab.capacity;
+
+    charSlabIndex = charSlabs.size() - 1;
+    charOffset = needed;
+    return slab.data;
+}
+
+// O(1) 清空, 不释放任何 slab
+void CityPool::reset() {
+    recordCount = 0;
+    freeHead = -1;
+    charSlabIndex = 0;
+    charOffset = 0;
+    counters.resets++;
+}
+
+// 释放全部内存
+void CityPool::releaseMemory() {
+    for (Record *slab : recordSlabs) {
+        delete[] slab;
+    }
+    for (const CharSlab &slab : charSlabs) {
+        delete[] slab.data;
+    }
+    recordSlabs.clear();
+    charSlabs.clear();
+    counters.slabBytes = 0;
+    recordCount = 0;
+    freeHead = -1;
+    charSlabIndex = 0;
+    charOffset = 0;
+}
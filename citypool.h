@@ -0,0 +1,86 @@
+#ifndef CITYPOOL_H
+#define CITYPOOL_H
+
+#include <QList>
+#include <QStringView>
+
+// 城市记录的内存池
+// 记录和城市名称的字符都从大块内存(slab)中顺序切分, 不再每个城市 new 一次;
+// reset() 只把分配游标拨回起点, 已申请的 slab 全部保留下来给下一次加载复用
+class CityPool {
+public:
+    // 城市记录, name 指向池内的字符区, name 为空表示该记录已被释放
+    struct Record {
+        double x;
+        double y;
+        const QChar *name;
+        int nameLength;
+        int nextFree; // 空闲链表中下一条记录的编号
+    };
+
+    // 分配统计, 用来确认重新加载时没有逐个城市的堆分配
+    struct Stats {
+        qint64 slabAllocations = 0;   // 向系统申请 slab 的次数
+        qint64 slabBytes = 0;         // 当前持有的 slab 总字节数
+        qint64 recordAllocations = 0; // 从池中分配记录的次数
+        qint64 recordReuses = 0;      // 复用已释放记录的次数
+        qint64 resets = 0;            // reset() 调用次数
+    };
+
+    CityPool();
+    ~CityPool();
+
+    CityPool(const CityPool &) = delete;
+    CityPool &operator=(const CityPool &) = delete;
+
+    // 分配一条记录并复制名称, 返回记录编号
+    int allocate(QStringView name, double x, double y);
+
+    // 释放记录, 编号放入空闲链表供下次复用(名称字符要等到 reset 才回收)
+    void release(int id);
+
+    // 按编号访问记录
+    Record &at(int id) {
+        return recordSlabs[id >> RECORD_SHIFT][id & RECORD_MASK];
+    }
+    const Record &at(int id) const {
+        return recordSlabs[id >> RECORD_SHIFT][id & RECORD_MASK];
+    }
+
+    // 已经使用过的编号上界, 遍历 [0, capacity()) 并跳过已释放的记录即可访问全部城市
+    int capacity() const { return recordCount; }
+
+    // O(1) 清空: 游标归零, 保留所有 slab
+    void reset();
+
+    // 归还所有 slab 给系统
+    void releaseMemory();
+
+    const Stats &stats() const { return counters; }
+
+private:
+    static const int RECORD_SHIFT = 12;
+    static const int RECORDS_PER_SLAB = 1 << RECORD_SHIFT; // 每块 4096 条记录
+    static const int RECORD_MASK = RECORDS_PER_SLAB - 1;
+    static const int CHARS_PER_SLAB = 1 << 16;             // 每块 64K 个字符
+
+    struct CharSlab {
+        QChar *data;
+        int capacity;
+    };
+
+    QList<Record *> recordSlabs;
+    int recordCount = 0;  // 已分配过的记录编号数
+    int freeHead = -1;    // 空闲链表头
+
+    QList<CharSlab> charSlabs;
+    int charSlabIndex = 0; // 当前使用的字符 slab
+    int charOffset = 0;    // 当前字符 slab 内的游标
+
+    Stats counters;
+
+    // 从字符区切出 length 个字符
+    QChar *allocateChars(int length);
+};
+
+#endif // CITYPOOL_H
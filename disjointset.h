@@ -0,0 +1,36 @@
+#ifndef DISJOINTSET_H
+#define DISJOINTSET_H
+
+#include <numeric>
+#include <vector>
+
+// 并查集(路径减半), 判断两个城市是否已经连通
+// Christofides 的 Kruskal 最小生成树和贪心边法构造回路都用它避免提前形成环
+class DisjointSet {
+public:
+    explicit DisjointSet(int size) : parent(size) {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+
+    int find(int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    // 合并 a, b 所在的集合; 已经在同一集合时返回 false
+    bool unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        parent[a] = b;
+        return true;
+    }
+
+private:
+    std::vector<int> parent;
+};
+
+#endif // DISJOINTSET_H
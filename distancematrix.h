@@ -0,0 +1,92 @@
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include <QtGlobal>
+#include <cmath>
+#include <vector>
+
+// 城市坐标的结构体数组(SoA)形式, 求解器只用编号访问城市, 不再复制 City 和城市名
+struct CityCoordinates {
+    std::vector<double> x;
+    std::vector<double> y;
+
+    int size() const { return static_cast<int>(x.size()); }
+
+    void append(double px, double py) {
+        x.push_back(px);
+        y.push_back(py);
+    }
+
+    // 两城市间的欧氏距离, 与 CityManager::distance() 数值一致
+    double distance(int i, int j) const {
+        double dx = x[i] - x[j];
+        double dy = y[i] - y[j];
+        return std::sqrt(dx * dx + dy * dy);
+    }
+};
+
+// 稠密距离矩阵, 每次求解前由坐标一次性建好, 求解器的内层循环只做查表
+// Real 选择 float 或 double 精度; Packed 为 true 时只保存下三角, 内存减半但访问多一次分支
+template <typename Real = double, bool Packed = false>
+class DistanceMatrix {
+public:
+    DistanceMatrix() {}
+    explicit DistanceMatrix(const CityCoordinates &coords) { build(coords); }
+
+    // 由坐标建表, 每对城市只计算一次
+    void build(const CityCoordinates &coords) {
+        n = coords.size();
+        values.assign(static_cast<size_t>(storageSize(n)), Real(0));
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < i; ++j) {
+                Real d = static_cast<Real>(coords.distance(i, j));
+                if (Packed) {
+                    values[packedIndex(i, j)] = d;
+                } else {
+                    values[static_cast<size_t>(i) * n + j] = d;
+                    values[static_cast<size_t>(j) * n + i] = d;
+                }
+            }
+        }
+    }
+
+    int size() const { return n; }
+
+    Real operator()(int i, int j) const {
+        if (Packed) {
+            if (i == j) return Real(0);
+            return i > j ? values[packedIndex(i, j)] : values[packedIndex(j, i)];
+        }
+        return values[static_cast<size_t>(i) * n + j];
+    }
+
+    // 稠密布局下第 i 行的首地址, 内层循环可以直接按列下标访问
+    const Real *row(int i) const {
+        static_assert(!Packed, "row() is only available for the dense layout");
+        return values.data() + static_cast<size_t>(i) * n;
+    }
+
+    // 整张表的首地址(稠密布局为 n*n, 行优先)
+    const Real *data() const { return values.data(); }
+
+    // 建表需要的内存(字节)
+    static qint64 memoryBytes(int cityCount) {
+        return storageSize(cityCount) * static_cast<qint64>(sizeof(Real));
+    }
+
+private:
+    int n = 0;
+    std::vector<Real> values;
+
+    static qint64 storageSize(int cityCount) {
+        qint64 count = cityCount;
+        return Packed ? count * (count - 1) / 2 : count * count;
+    }
+
+    // 下三角 (i > j) 的存储位置
+    static size_t packedIndex(int i, int j) {
+        return static_cast<size_t>(i) * (i - 1) / 2 + j;
+    }
+};
+
+#endif // DISTANCEMATRIX_H
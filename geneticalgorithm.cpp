@@ -0,0 +1,418 @@
+#include "geneticalgorithm.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+const double EPS = 1e-10; // 小于该值的差别视为舍入误差
+
+bool hasLink(const std::vector<int> &link, int u, int v) {
+    return link[2 * u] == v || link[2 * u + 1] == v;
+}
+
+// 把 u 的相邻城市 from 换成 to
+void replaceLink(std::vector<int> &link, int u, int from, int to) {
+    link[link[2 * u] == from ? 2 * u : 2 * u + 1] = to;
+}
+
+} // namespace
+
+GeneticAlgorithm::GeneticAlgorithm(const CityCoordinates &coords, int threadCount)
+    : coords(coords), n(coords.size()), candidates(coords), k(candidates.neighborCount()), pool(threadCount) {
+}
+
+QString GeneticAlgorithm::crossoverName(Crossover type) {
+    switch (type) {
+    case EdgeAssembly: return "边组装交叉(EAX)";
+    case Order: return "顺序交叉(OX)";
+    }
+    return QString();
+}
+
+void GeneticAlgorithm::toLinks(const std::vector<int> &tour, std::vector<int> &link) {
+    int size = static_cast<int>(tour.size());
+    link.resize(2 * size);
+    for (int p = 0; p < size; ++p) {
+        int v = tour[p];
+        link[2 * v] = tour[p == 0 ? size - 1 : p - 1];
+        link[2 * v + 1] = tour[p + 1 == size ? 0 : p + 1];
+    }
+}
+
+void GeneticAlgorithm::fromLinks(const std::vector<int> &link, std::vector<int> &tour) const {
+    tour.resize(n);
+    int prev = -1;
+    int current = 0;
+    for (int p = 0; p < n; ++p) {
+        tour[p] = current;
+        int next = link[2 * current] != prev ? link[2 * current] : link[2 * current + 1];
+        prev = current;
+        current = next;
+    }
+}
+
+void GeneticAlgorithm::initialize(Island &island, const QElapsedTimer &timer) const {
+    island.population.resize(populationSize);
+    island.lengths.resize(populationSize);
+    for (int i = 0; i < populationSize; ++i) {
+        // 随机排列经局部搜索, 比最近邻回路的差别大, 种群多样性更好
+        std::vector<int> &tour = island.population[i];
+        tour.resize(n);
+        std::iota(tour.begin(), tour.end(), 0);
+        for (int j = n - 1; j > 0; --j) {
+            std::swap(tour[j], tour[island.gen.uniform(j + 1)]);
+        }
+        island.lengths[i] = timeUp(timer) ? island.search.tourLength(tour) : island.search.optimize(tour);
+    }
+
+    island.linkA.resize(2 * n);
+    island.linkB.resize(2 * n);
+    island.firstEven.assign(n, -1);
+    island.firstOdd.assign(n, -1);
+    island.label.resize(n);
+}
+
+void GeneticAlgorithm::evolve(Island &island) const {
+    // 随机排列个体, 每个个体与排在它后面的个体配对
+    std::vector<int> order(populationSize);
+    std::iota(order.begin(), order.end(), 0);
+    for (int i = populationSize - 1; i > 0; --i) {
+        std::swap(order[i], order[island.gen.uniform(i + 1)]);
+    }
+    for (int i = 0; i < populationSize; ++i) {
+        int a = order[i];
+        int b = order[(i + 1) % populationSize];
+        if (crossover == EdgeAssembly) {
+            edgeAssembly(island, a, b);
+        } else {
+            orderCrossover(island, a, b);
+        }
+    }
+}
+
+void GeneticAlgorithm::edgeAssembly(Island &island, int a, int b) const {
+    toLinks(island.population[a], island.linkA);
+    toLinks(island.population[b], island.linkB);
+
+    island.differing.clear();
+    for (int v = 0; v < n; ++v) {
+        if (!hasLink(island.linkB, v, island.linkA[2 * v]) || !hasLink(island.linkB, v, island.linkA[2 * v + 1])) {
+            island.differing.push_back(v);
+        }
+    }
+    if (island.differing.empty()) return; // 两个父代相同
+
+    double bestDelta = -EPS;
+    bool found = false;
+    for (int c = 0; c < childrenPerPair; ++c) {
+        double delta = 0;
+        if (!applyRandomABCycle(island, delta)) continue;
+        if (delta < bestDelta) {
+            bestDelta = delta;
+            island.bestChild.swap(island.child);
+            found = true;
+        }
+    }
+    if (found) {
+        fromLinks(island.bestChild, island.population[a]);
+        island.lengths[a] += bestDelta;
+        island.replacements++;
+    }
+}
+
+bool GeneticAlgorithm::applyRandomABCycle(Island &island, double &delta) const {
+    // 去掉两个父代共有的边, 剩下的 A 边和 B 边在每个城市上一样多
+    std::vector<int> &remainA = island.remainA;
+    std::vector<int> &remainB = island.remainB;
+    remainA = island.linkA;
+    remainB = island.linkB;
+    for (int v : island.differing) {
+        for (int s = 0; s < 2; ++s) {
+            if (hasLink(island.linkB, v, remainA[2 * v + s])) remainA[2 * v + s] = -1;
+            if (hasLink(island.linkA, v, remainB[2 * v + s])) remainB[2 * v + s] = -1;
+        }
+    }
+    // 邻边全部共有的城市不在 differing 中, 也不会被走到, 不必处理
+
+    // 从随机城市出发交替走 A 边(偶数步)和 B 边(奇数步), 第二次以相同奇偶性到达某城市时得到 AB 环
+    std::vector<int> &path = island.path;
+    path.clear();
+    int v = island.differing[island.gen.uniform(static_cast<int>(island.differing.size()))];
+    path.push_back(v);
+    island.firstEven[v] = 0;
+    int cycleStart = -1;
+    while (cycleStart < 0) {
+        int step = static_cast<int>(path.size()) - 1;
+        std::vector<int> &remain = step % 2 == 0 ? remainA : remainB;
+        int s0 = remain[2 * v], s1 = remain[2 * v + 1];
+        if (s0 < 0 && s1 < 0) break;
+        int slot = s0 < 0 ? 1 : (s1 < 0 ? 0 : island.gen.uniform(2));
+        int w = remain[2 * v + slot];
+        remain[2 * v + slot] = -1;
+        remain[remain[2 * w] == v ? 2 * w : 2 * w + 1] = -1;
+
+        path.push_back(w);
+        std::vector<int> &first = (step + 1) % 2 == 0 ? island.firstEven : island.firstOdd;
+        if (first[w] >= 0) {
+            cycleStart = first[w];
+        } else {
+            first[w] = step + 1;
+        }
+        v = w;
+    }
+    for (int city : path) {
+        island.firstEven[city] = -1;
+        island.firstOdd[city] = -1;
+    }
+    if (cycleStart < 0) return false;
+
+    // 删除环上的 A 边, 再加上 B 边; 每个城市删几条就加几条, 度数保持为 2
+    std::vector<int> &child = island.child;
+    child = island.linkA;
+    int end = static_cast<int>(path.size()) - 1;
+    delta = 0;
+    for (int e = cycleStart; e < end; ++e) {
+        int u = path[e], w = path[e + 1];
+        if (e % 2 == 0) {
+            replaceLink(child, u, w, -1);
+            replaceLink(child, w, u, -1);
+            delta -= dist(u, w);
+        }
+    }
+    for (int e = cycleStart; e < end; ++e) {
+        int u = path[e], w = path[e + 1];
+        if (e % 2 == 1) {
+            replaceLink(child, u, -1, w);
+            replaceLink(child, w, -1, u);
+            delta += dist(u, w);
+        }
+    }
+
+    delta += mergeSubtours(island);
+    return true;
+}
+
+double GeneticAlgorithm::mergeSubtours(Island &island) const {
+    std::vector<int> &link = island.child;
+    std::vector<int> &label = island.label;
+    std::vector<int> &size = island.subtourSize;
+
+    std::fill(label.begin(), label.end(), -1);
+    size.clear();
+    for (int start = 0; start < n; ++start) {
+        if (label[start] >= 0) continue;
+        int id = static_cast<int>(size.size());
+        int count = 0;
+        int prev = -1;
+        int current = start;
+        while (label[current] < 0) {
+            label[current] = id;
+            count++;
+            int next = link[2 * current] != prev ? link[2 * current] : link[2 * current + 1];
+            prev = current;
+            current = next;
+        }
+        size.push_back(count);
+    }
+
+    double delta = 0;
+    std::vector<int> members;
+    for (int remaining = static_cast<int>(size.size()); remaining > 1; --remaining) {
+        // 每次合并最小的子回路: 删去它的一条边 (u,u2) 和相邻子回路的一条边 (w,w2), 连上 (u,w), (u2,w2)
+        int smallest = -1;
+        for (int id = 0; id < static_cast<int>(size.size()); ++id) {
+            if (size[id] > 0 && (smallest < 0 || size[id] < size[smallest])) smallest = id;
+        }
+        members.clear();
+        for (int v = 0; v < n; ++v) {
+            if (label[v] == smallest) members.push_back(v);
+        }
+
+        double best = std::numeric_limits<double>::max();
+        int bu = -1, bu2 = -1, bw = -1, bw2 = -1;
+        auto consider = [&](int u, int w) {
+            for (int s = 0; s < 2; ++s) {
+                int u2 = link[2 * u + s];
+                for (int r = 0; r < 2; ++r) {
+                    int w2 = link[2 * w + r];
+                    double cost = dist(u, w) + dist(u2, w2) - dist(u, u2) - dist(w, w2);
+                    if (cost < best) {
+                        best = cost;
+                        bu = u; bu2 = u2; bw = w; bw2 = w2;
+                    }
+                }
+            }
+        };
+        for (int u : members) {
+            const int *neighbor = candidates.neighbors(u);
+            for (int t = 0; t < k; ++t) {
+                if (label[neighbor[t]] != smallest) consider(u, neighbor[t]);
+            }
+        }
+        if (bu < 0) {
+            // 候选邻居都在同一个子回路里, 扫描全部城市找离它最近的外部城市
+            int u = members[0];
+            int nearest = -1;
+            for (int w = 0; w < n; ++w) {
+                if (label[w] != smallest && (nearest < 0 || dist(u, w) < dist(u, nearest))) nearest = w;
+            }
+            consider(u, nearest);
+        }
+
+        replaceLink(link, bu, bu2, bw);
+        replaceLink(link, bu2, bu, bw2);
+        replaceLink(link, bw, bw2, bu);
+        replaceLink(link, bw2, bw, bu2);
+        delta += best;
+
+        int target = label[bw];
+        for (int v : members) label[v] = target;
+        size[target] += size[smallest];
+        size[smallest] = 0;
+    }
+    return delta;
+}
+
+void GeneticAlgorithm::orderCrossover(Island &island, int a, int b) const {
+    const std::vector<int> &parentA = island.population[a];
+    const std::vector<int> &parentB = island.population[b];
+    int first = island.gen.uniform(n);
+    int length = island.gen.uniform(1, n - 1);
+
+    // firstEven 借作"已在子代中"的标记
+    std::vector<int> &taken = island.firstEven;
+    std::vector<int> &child = island.child;
+    child.clear();
+    for (int i = 0; i < length; ++i) {
+        int city = parentA[(first + i) % n];
+        child.push_back(city);
+        taken[city] = 1;
+    }
+    int start = std::find(parentB.begin(), parentB.end(), child.back()) - parentB.begin();
+    for (int i = 1; i <= n; ++i) {
+        int city = parentB[(start + i) % n];
+        if (taken[city] < 0) child.push_back(city);
+    }
+    for (int city : child) taken[city] = -1;
+
+    double childLength = island.search.optimize(child);
+    if (childLength < island.lengths[a] - EPS) {
+        island.population[a] = child;
+        island.lengths[a] = childLength;
+        island.replacements++;
+    }
+}
+
+std::vector<int> GeneticAlgorithm::solve() {
+    QElapsedTimer timer;
+    timer.start();
+    progress = Progress();
+
+    std::vector<int> best(n);
+    std::iota(best.begin(), best.end(), 0);
+    if (n <= 3) {
+        progress.bestLength = candidates.tourLength(best);
+        return best;
+    }
+
+    // 各岛的随机数流按岛的编号分配, 与执行它的线程无关
+    int count = islandCount();
+    std::vector<Island> islands;
+    islands.reserve(count);
+    Xoshiro256 stream(seed);
+    for (int i = 0; i < count; ++i) {
+        islands.emplace_back(candidates);
+        stream.jump();
+        islands[i].gen = stream;
+    }
+    pool.run(count, [&](int i, int) { initialize(islands[i], timer); });
+
+    double bestLength = std::numeric_limits<double>::max();
+    auto collect = [&]() {
+        bool improved = false;
+        double sum = 0;
+        progress.convergedIslands = 0;
+        for (const Island &island : islands) {
+            auto range = std::minmax_element(island.lengths.begin(), island.lengths.end());
+            if (*range.first < bestLength - EPS) {
+                bestLength = *range.first;
+                best = island.population[range.first - island.lengths.begin()];
+                improved = true;
+            }
+            if (*range.second - *range.first < EPS) progress.convergedIslands++;
+            sum += std::accumulate(island.lengths.begin(), island.lengths.end(), 0.0);
+        }
+        progress.bestLength = bestLength;
+        progress.averageLength = sum / (count * populationSize);
+        progress.elapsedMs = timer.elapsed();
+        return improved;
+    };
+    collect();
+
+    while (progress.generation < maxGenerations) {
+        if (timeUp(timer)) break;
+        if (progress.convergedIslands == count || cancelled()) break;
+
+        // 每一代之前都检查取消和时间上限, 不必等到迁移周期结束
+        int generations = qMin(migrationInterval, maxGenerations - progress.generation);
+        pool.run(count, [&](int i, int) {
+            Island &island = islands[i];
+            island.replacements = 0;
+            island.generations = 0;
+            while (island.generations < generations && !cancelled() && !timeUp(timer)) {
+                evolve(island);
+                island.generations++;
+            }
+        });
+        int changes = 0;
+        int evolved = 0;
+        for (const Island &island : islands) {
+            changes += island.replacements;
+            evolved = qMax(evolved, island.generations);
+        }
+        progress.generation += evolved;
+
+        // 环形迁移: 先取出所有岛的最优个体, 再替换下一个岛中最差的个体(已有相同长度的个体时不替换)
+        std::vector<int> elite(count);
+        for (int i = 0; i < count; ++i) {
+            elite[i] = std::min_element(islands[i].lengths.begin(), islands[i].lengths.end()) - islands[i].lengths.begin();
+        }
+        std::vector<std::vector<int>> migrants(count);
+        std::vector<double> migrantLengths(count);
+        for (int i = 0; i < count; ++i) {
+            migrants[i] = islands[i].population[elite[i]];
+            migrantLengths[i] = islands[i].lengths[elite[i]];
+        }
+        for (int i = 0; i < count; ++i) {
+            Island &target = islands[(i + 1) % count];
+            bool duplicate = false;
+            for (double length : target.lengths) {
+                if (std::abs(length - migrantLengths[i]) < EPS) duplicate = true;
+            }
+            if (duplicate) continue;
+            int worst = std::max_element(target.lengths.begin(), target.lengths.end()) - target.lengths.begin();
+            target.population[worst] = migrants[i];
+            target.lengths[worst] = migrantLengths[i];
+            changes++;
+        }
+        progress.migrations++;
+
+        progress.improved = collect();
+        if (callback) {
+            progress.tour = &best;
+            callback(progress);
+            progress.tour = nullptr;
+        }
+
+        // 整个周期里没有子代被接受, 迁移也带不来新个体, 再进化下去不会有变化
+        if (changes == 0) break;
+    }
+
+    // 长度按增量累计, 最后按坐标重算一次
+    progress.bestLength = candidates.tourLength(best);
+    progress.elapsedMs = timer.elapsed();
+    return best;
+}
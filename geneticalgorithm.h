@@ -0,0 +1,142 @@
+#ifndef GENETICALGORITHM_H
+#define GENETICALGORITHM_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "distancematrix.h"
+#include "localsearch.h"
+#include "threadpool.h"
+#include "xoshiro256.h"
+
+// 岛屿模型遗传算法
+// 种群分成若干个岛, 每个岛在线程池上独立进化, 每隔 migrationInterval 代把各岛的最优个体复制到环上的下一个岛, 替换那里最差的个体.
+// 个体就是城市编号数组, 初始个体是随机排列经局部搜索得到的局部最优解.
+// 所有岛都收敛, 或者整个迁移周期内种群没有任何变化时提前结束.
+// 交叉算子:
+//   EdgeAssembly(边组装, EAX): 两个父代边的对称差中找一个 A/B 边交替的环, 在父代 A 上删去环中 A 的边、加上 B 的边,
+//     产生的子回路用候选邻居上代价最小的 2-opt 式换边逐个合并; 每对父代生成多个子代, 最好的子代比 A 短时替换 A
+//   Order(顺序交叉, OX): 子代保留 A 的一段, 其余城市按在 B 中的顺序填入, 再做局部搜索
+// 每个岛有自己的随机数流(由种子 jump() 分出), 种子、岛数和代数相同时结果可重现, 与线程数无关
+class GeneticAlgorithm {
+public:
+    enum Crossover {
+        EdgeAssembly,
+        Order
+    };
+
+    // 进度信息
+    struct Progress {
+        int generation = 0;        // 已完成的代数
+        double bestLength = 0;     // 所有岛中最优个体的长度
+        double averageLength = 0;  // 所有个体的平均长度
+        int convergedIslands = 0;  // 所有个体长度相同(已收敛)的岛数
+        int migrations = 0;        // 已进行的迁移次数
+        qint64 elapsedMs = 0;      // 已用时间
+        bool improved = false;     // 本次迁移周期内是否找到更优解
+        const std::vector<int> *tour = nullptr; // 最优个体, 只在回调期间有效
+    };
+
+    // 坐标需在对象使用期间保持有效; 岛数等于线程数(至少 2), threadCount <= 0 时使用 CPU 核心数
+    explicit GeneticAlgorithm(const CityCoordinates &coords, int threadCount = 0);
+
+    void setCrossover(Crossover type) { crossover = type; }
+
+    // 每个岛的个体数, 默认 50
+    void setPopulationSize(int size) { populationSize = qMax(2, size); }
+
+    // EAX 中每对父代生成的子代数
+    void setChildrenPerPair(int count) { childrenPerPair = qMax(1, count); }
+
+    // 最大代数和时间上限(毫秒), 先到为准; 时间上限为 0 表示不限
+    void setGenerations(int count) { maxGenerations = qMax(1, count); }
+    void setTimeLimit(qint64 ms) { timeLimitMs = ms; }
+
+    // 每隔多少代迁移一次
+    void setMigrationInterval(int generations) { migrationInterval = qMax(1, generations); }
+
+    void setSeed(quint64 value) { seed = value; }
+
+    // 取消标志, 置位后各岛在当前一代结束时停止, 返回目前最优个体
+    void setCancelFlag(const std::atomic<bool> *flag) {
+        cancelFlag = flag;
+        candidates.setCancelFlag(flag); // 各岛的局部搜索由它复制而来
+    }
+
+    // 进度回调, 每次迁移后调用一次
+    void setProgressCallback(std::function<void(const Progress &)> func) { callback = func; }
+
+    // 返回最优个体(城市编号序列)
+    std::vector<int> solve();
+
+    const Progress &lastProgress() const { return progress; }
+    int islandCount() const { return qMax(2, pool.threadCount()); }
+    int threadCount() const { return pool.threadCount(); }
+
+    static QString crossoverName(Crossover type);
+
+private:
+    // 一个岛: 种群、随机数流和交叉用的缓冲区
+    struct Island {
+        explicit Island(const LocalSearch<> &search) : search(search) {}
+
+        std::vector<std::vector<int>> population;
+        std::vector<double> lengths;
+        int replacements = 0; // 本周期内被子代替换的次数
+        int generations = 0;  // 本周期内实际进化的代数, 取消或超时时少于迁移间隔
+        Xoshiro256 gen;
+        LocalSearch<> search;
+
+        // EAX 缓冲区, 回路用每个城市的两个相邻城市表示: link[2v], link[2v+1]
+        std::vector<int> linkA, linkB, remainA, remainB, child, bestChild;
+        std::vector<int> path, firstEven, firstOdd;
+        std::vector<int> label, subtourSize;
+        std::vector<int> differing; // 两个父代邻边不同的城市, AB 环从这里出发
+    };
+
+    const CityCoordinates &coords;
+    int n;
+    LocalSearch<> candidates; // 候选邻居表
+    int k;
+    WorkStealingPool pool;
+    Crossover crossover = EdgeAssembly;
+    int populationSize = 50;
+    int childrenPerPair = 8;
+    int maxGenerations = 1000;
+    int migrationInterval = 10;
+    qint64 timeLimitMs = 0;
+    quint64 seed = 0;
+    const std::atomic<bool> *cancelFlag = nullptr;
+    std::function<void(const Progress &)> callback;
+    Progress progress;
+
+    double dist(int a, int b) const { return coords.distance(a, b); }
+    bool cancelled() const { return cancelFlag && cancelFlag->load(std::memory_order_relaxed); }
+    bool timeUp(const QElapsedTimer &timer) const { return timeLimitMs > 0 && timer.elapsed() >= timeLimitMs; }
+
+    // 用随机排列经局部搜索得到的局部最优解生成初始种群; 超时后剩下的个体不再做局部搜索
+    void initialize(Island &island, const QElapsedTimer &timer) const;
+
+    // 进化一代
+    void evolve(Island &island) const;
+
+    // EAX: 由父代 a, b 生成子代, 最好的子代比 a 短时替换 a
+    void edgeAssembly(Island &island, int a, int b) const;
+
+    // 在 island.linkA 上应用一个随机 AB 环并合并子回路, 结果在 island.child 中, 返回长度增量; 找不到 AB 环时返回 false
+    bool applyRandomABCycle(Island &island, double &delta) const;
+
+    // 把 link 中的子回路合并成一条, 返回长度增量
+    double mergeSubtours(Island &island) const;
+
+    // OX: 由父代 a, b 生成一个子代并做局部搜索, 比 a 短时替换 a
+    void orderCrossover(Island &island, int a, int b) const;
+
+    static void toLinks(const std::vector<int> &tour, std::vector<int> &link);
+    void fromLinks(const std::vector<int> &link, std::vector<int> &tour) const;
+};
+
+#endif // GENETICALGORITHM_H
@@ -0,0 +1,264 @@
+#include "linkernighan.h"
+#include <QElapsedTimer>
+
+namespace {
+const double EPS = 1e-10; // 小于该值的改进视为舍入误差
+}
+
+template <typename Tour>
+LinKernighan<Tour>::LinKernighan(const CityCoordinates &coords, int neighborCount)
+    : coords(coords), n(coords.size()), localSearch(coords, neighborCount), k(localSearch.neighborCount()) {
+}
+
+template <typename Tour>
+void LinKernighan<Tour>::setProgressCallback(std::function<void(const Progress &)> callback, qint64 intervalMs) {
+    this->callback = std::move(callback);
+    callbackIntervalMs = intervalMs;
+}
+
+template <typename Tour>
+void LinKernighan<Tour>::push(int city) {
+    if (!queued[city]) {
+        queued[city] = 1;
+        queue.push_back(city);
+    }
+}
+
+template <typename Tour>
+void LinKernighan<Tour>::makeFlip(int a, int b, int c, int d) {
+    tour.flip(a, b, c, d);
+    log.push_back({a, b, c, d});
+}
+
+template <typename Tour>
+void LinKernighan<Tour>::reversePath(int p, int x, int y, int q) {
+    if (tour.next(p) == x) {
+        makeFlip(p, x, y, q);
+    } else {
+        makeFlip(q, y, x, p);
+    }
+}
+
+// 2-opt 的逆操作仍是一次 2-opt: 删除 (a,c), (b,d), 加回 (a,b), (c,d)
+template <typename Tour>
+void LinKernighan<Tour>::undoTo(size_t size) {
+    while (log.size() > size) {
+        Flip flip = log.back();
+        log.pop_back();
+        if (tour.next(flip.a) == flip.c) {
+            tour.flip(flip.a, flip.c, flip.b, flip.d);
+        } else {
+            tour.flip(flip.d, flip.b, flip.c, flip.a);
+        }
+    }
+}
+
+template <typename Tour>
+bool LinKernighan<Tour>::isAdded(int a, int b) const {
+    for (const auto &edge : added) {
+        if ((edge.first == a && edge.second == b) || (edge.first == b && edge.second == a)) return true;
+    }
+    return false;
+}
+
+// 候选 t3 取自 last 的近邻, t4 是 t3 在 last 一侧的相邻城市, 这样 2-opt 后仍是一条回路
+template <typename Tour>
+int LinKernighan<Tour>::collectCandidates(int t1, int last, double gain, int limit, int *t3s, int *t4s) const {
+    bool forward = tour.next(t1) == last;
+    const int *candidates = localSearch.neighbors(last);
+    double scores[8];
+    int count = 0;
+
+    for (int t = 0; t < k; ++t) {
+        int t3 = candidates[t];
+        double g1 = gain - dist(last, t3);
+        if (g1 <= EPS) break; // 部分增益必须为正, 后面的邻居更远
+        if (t3 == t1) continue;
+        int t4 = forward ? tour.prev(t3) : tour.next(t3);
+        if (t4 == last || isAdded(t3, t4)) continue;
+
+        // 插入排序, 只保留得分最高的 limit 个
+        double score = g1 + dist(t3, t4);
+        int at = count < limit ? count++ : limit;
+        if (at == limit && score <= scores[limit - 1]) continue;
+        if (at == limit) at = limit - 1;
+        while (at > 0 && scores[at - 1] < score) {
+            scores[at] = scores[at - 1];
+            t3s[at] = t3s[at - 1];
+            t4s[at] = t4s[at - 1];
+            at--;
+        }
+        scores[at] = score;
+        t3s[at] = t3;
+        t4s[at] = t4;
+    }
+    return count;
+}
+
+// 一次 LK 搜索: 第一层最多尝试 breadth 个候选, 更深的层次贪心地取得分最高的候选
+template <typename Tour>
+double LinKernighan<Tour>::improveFrom(int t1) {
+    int t3s[8], t4s[8];
+
+    for (int dir = 0; dir < 2; ++dir) {
+        int t2 = dir == 0 ? tour.next(t1) : tour.prev(t1);
+        double g0 = dist(t1, t2);
+        int firstCount = collectCandidates(t1, t2, g0, breadth, t3s, t4s);
+        int firstT3[8], firstT4[8];
+        std::copy(t3s, t3s + firstCount, firstT3);
+        std::copy(t4s, t4s + firstCount, firstT4);
+
+        for (int first = 0; first < firstCount; ++first) {
+            size_t mark = log.size();
+            added.clear();
+            double gain = g0;
+            double bestGain = 0;
+            size_t bestSize = mark;
+            int last = t2;
+            int t3 = firstT3[first];
+            int t4 = firstT4[first];
+
+            for (int depth = 0; depth < maxDepth; ++depth) {
+                if (depth > 0) {
+                    if (collectCandidates(t1, last, gain, 1, t3s, t4s) == 0) break;
+                    t3 = t3s[0];
+                    t4 = t4s[0];
+                }
+                // 删除 (t1,last), (t4,t3), 加入 (last,t3), (t1,t4)
+                reversePath(t1, last, t4, t3);
+                added.push_back({last, t3});
+                gain += dist(t3, t4) - dist(last, t3);
+                last = t4;
+
+                double closed = gain - dist(t4, t1);
+                if (closed > bestGain + EPS) {
+                    bestGain = closed;
+                    bestSize = log.size();
+                }
+            }
+
+            undoTo(bestSize);
+            if (bestGain > EPS) {
+                for (size_t i = mark; i < log.size(); ++i) {
+                    push(log[i].a);
+                    push(log[i].b);
+                    push(log[i].c);
+                    push(log[i].d);
+                }
+                return bestGain;
+            }
+        }
+    }
+    return 0;
+}
+
+template <typename Tour>
+void LinKernighan<Tour>::runQueue() {
+    while (!queue.empty() && !cancelled()) {
+        int t1 = queue.front();
+        queue.pop_front();
+        queued[t1] = 0;
+        currentLength -= improveFrom(t1);
+    }
+}
+
+// 在随机城市之后不远处截出相邻的两段 B, C 并交换: A B C D -> A C B D
+// 用三次翻转实现, 每次翻转都记入日志, 可以整体撤销
+template <typename Tour>
+double LinKernighan<Tour>::kick() {
+    int window = qMin(50, n - 3);
+    int o1 = rng.uniform(1, window);
+    int o2 = rng.uniform(1, window);
+    while (o2 == o1) o2 = rng.uniform(1, window);
+    if (o1 > o2) std::swap(o1, o2);
+
+    int a1 = rng.uniform(n);
+    int b1 = tour.next(a1);
+    int b2 = a1;
+    for (int i = 0; i < o1; ++i) b2 = tour.next(b2);
+    int c1 = tour.next(b2);
+    int c3 = b2;
+    for (int i = o1; i < o2; ++i) c3 = tour.next(c3);
+    int d1 = tour.next(c3);
+
+    double delta = dist(a1, c1) + dist(c3, b1) + dist(b2, d1)
+                   - dist(a1, b1) - dist(b2, c1) - dist(c3, d1);
+
+    reversePath(a1, b1, c3, d1); // A C' B' D
+    reversePath(a1, c3, c1, b2); // A C B' D
+    reversePath(c3, b2, b1, d1); // A C B D
+
+    for (int city : {a1, b1, b2, c1, c3, d1}) push(city);
+    return delta;
+}
+
+// 从给定回路开始的链式 LK
+template <typename Tour>
+double LinKernighan<Tour>::optimize(std::vector<int> &route) {
+    QElapsedTimer timer;
+    timer.start();
+    progress = Progress();
+
+    if (n < 8 || static_cast<int>(route.size()) != n) {
+        progress.initialLength = progress.length = localSearch.optimize(route);
+        return progress.length;
+    }
+
+    // 先用 2-opt/Or-opt 快速下降, 再求 LK 局部最优; 局部搜索与 LK 使用同一种回路表示
+    localSearch.optimize(route);
+    tour.init(route);
+    currentLength = localSearch.tourLength(route);
+    queue.clear();
+    queued.assign(n, 0);
+    for (int city : route) push(city);
+    log.clear();
+    runQueue();
+    log.clear();
+
+    progress.initialLength = currentLength;
+    progress.length = currentLength;
+    qint64 lastReport = 0;
+
+    while (timeLimitMs > 0 && timer.elapsed() < timeLimitMs && !cancelled()) {
+        double before = currentLength;
+        currentLength += kick();
+        runQueue();
+
+        progress.kicks++;
+        progress.improved = currentLength < before - EPS;
+        if (progress.improved) {
+            progress.improvements++;
+        } else {
+            // 没有变短, 撤销扰动及其后的全部操作
+            undoTo(0);
+            currentLength = before;
+        }
+        log.clear();
+
+        if (callback && timer.elapsed() - lastReport >= callbackIntervalMs) {
+            lastReport = timer.elapsed();
+            progress.length = currentLength;
+            progress.elapsedMs = lastReport;
+            std::vector<int> snapshot = tour.order();
+            progress.tour = &snapshot;
+            callback(progress);
+            progress.tour = nullptr;
+        }
+    }
+
+    route = tour.order();
+    progress.length = localSearch.tourLength(route); // 重新求和, 去掉增量累加的舍入误差
+    progress.elapsedMs = timer.elapsed();
+    progress.improved = false;
+    return progress.length;
+}
+
+template <typename Tour>
+std::vector<int> LinKernighan<Tour>::solve() {
+    std::vector<int> route = localSearch.nearestNeighborTour();
+    optimize(route);
+    return route;
+}
+
+template class LinKernighan<ArrayTour>;
+template class LinKernighan<TwoLevelTour>;
@@ -0,0 +1,120 @@
+#ifndef LINKERNIGHAN_H
+#define LINKERNIGHAN_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "arraytour.h"
+#include "distancematrix.h"
+#include "localsearch.h"
+#include "twoleveltour.h"
+#include "xoshiro256.h"
+
+// Lin-Kernighan 式变深度搜索(链式 LK)
+// 每一步删除与起点 t1 相连的一条边 (t1,t2), 在 t2 的候选邻居中选 t3 连边, 再删去 t3 的一条边 (t3,t4),
+// 用一次 2-opt 把回路重新闭合, 然后以 (t1,t4) 为下一条待删边继续加深; 部分增益必须始终为正,
+// 最后退回到闭合增益最大的深度. 到达局部最优后用局部双桥扰动(segment swap)跳出,
+// 扰动后只重新检查附近的城市, 没有变好就按操作日志撤销
+// Tour 为回路表示: ArrayTour 翻转短路径最快, TwoLevelTour 在几十万城市以上翻转长路径时更快
+template <typename Tour = ArrayTour>
+class LinKernighan {
+public:
+    // 进度信息
+    struct Progress {
+        qint64 kicks = 0;         // 已尝试的扰动次数
+        qint64 improvements = 0;  // 使回路变短的扰动次数
+        double initialLength = 0; // 首次到达 LK 局部最优时的回路长度
+        double length = 0;        // 当前回路长度
+        qint64 elapsedMs = 0;     // 已用时间
+        bool improved = false;    // 本次是否变短
+        const std::vector<int> *tour = nullptr; // 当前回路, 只在回调期间有效
+    };
+
+    // 坐标需在对象使用期间保持有效
+    explicit LinKernighan(const CityCoordinates &coords, int neighborCount = 8);
+
+    // 时间上限(毫秒); 0 表示不做扰动, 只求一次 LK 局部最优
+    void setTimeLimit(qint64 ms) { timeLimitMs = ms; }
+
+    // 每条链的最大深度
+    void setMaxDepth(int depth) { maxDepth = qMax(1, depth); }
+
+    // 随机种子(扰动位置), 相同种子和时间内的扰动次数相同时结果可重现
+    void setSeed(quint64 seed) { rng.seed(seed); }
+
+    // 取消标志, 置位后尽快结束并返回当前回路
+    void setCancelFlag(const std::atomic<bool> *flag) {
+        cancelFlag = flag;
+        localSearch.setCancelFlag(flag);
+    }
+
+    // 进度回调, 扰动阶段每隔 intervalMs 毫秒调用一次; 结束时的状态见 lastProgress()
+    void setProgressCallback(std::function<void(const Progress &)> callback, qint64 intervalMs = 1000);
+
+    // 最近邻得到初始回路, 再做链式 LK, 返回城市编号序列
+    std::vector<int> solve();
+
+    // 从给定回路开始做链式 LK, 就地修改并返回长度
+    double optimize(std::vector<int> &route);
+
+    const Progress &lastProgress() const { return progress; }
+
+private:
+    // 一次 2-opt 操作, 含义同 Tour::flip
+    struct Flip {
+        int a, b, c, d;
+    };
+
+    const CityCoordinates &coords;
+    int n;
+    LocalSearch<Tour> localSearch; // 提供候选邻居表和初始局部搜索
+    int k;
+    int maxDepth = 50;
+    int breadth = 5; // 第一层尝试的候选数
+    qint64 timeLimitMs = 0;
+    std::function<void(const Progress &)> callback;
+    qint64 callbackIntervalMs = 1000;
+    const std::atomic<bool> *cancelFlag = nullptr;
+    Xoshiro256 rng;
+
+    Tour tour;
+    std::vector<Flip> log;        // 操作日志, 用于撤销
+    std::deque<int> queue;        // 待检查的城市(don't-look 标记未置位)
+    std::vector<char> queued;
+    std::vector<std::pair<int, int>> added; // 当前链加入的边, 不允许再删除
+    double currentLength = 0;
+    Progress progress;
+
+    double dist(int a, int b) const { return coords.distance(a, b); }
+    bool cancelled() const { return cancelFlag && cancelFlag->load(std::memory_order_relaxed); }
+
+    void push(int city);
+    void makeFlip(int a, int b, int c, int d);
+
+    // 删除 (p,x), (y,q), 加入 (p,y), (x,q): 翻转夹在 p 与 q 之间的路径 x..y, 不依赖回路方向
+    void reversePath(int p, int x, int y, int q);
+
+    // 撤销日志中 size 之后的操作
+    void undoTo(size_t size);
+
+    bool isAdded(int a, int b) const;
+
+    // 为当前待删边 (t1,last) 选择 t3/t4, 返回按 g - d(last,t3) + d(t3,t4) 从大到小的至多 limit 个候选
+    int collectCandidates(int t1, int last, double gain, int limit, int *t3s, int *t4s) const;
+
+    // 以 t1 为起点做一次 LK 搜索, 返回闭合增益(0 表示没有改进)
+    double improveFrom(int t1);
+
+    // 处理队列直到所有城市都置上 don't-look 标记
+    void runQueue();
+
+    // 局部双桥扰动, 返回回路长度的变化
+    double kick();
+};
+
+extern template class LinKernighan<ArrayTour>;
+extern template class LinKernighan<TwoLevelTour>;
+
+#endif // LINKERNIGHAN_H
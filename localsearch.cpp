@@ -0,0 +1,253 @@
+#include "localsearch.h"
+#include "spatialgrid.h"
+#include <QElapsedTimer>
+#include <algorithm>
+
+namespace {
+const double EPS = 1e-10; // 小于该值的改进视为舍入误差
+}
+
+template <typename Tour>
+LocalSearch<Tour>::LocalSearch(const CityCoordinates &coords, int neighborCount)
+    : coords(coords), n(coords.size()), k(qMax(0, qMin(neighborCount, coords.size() - 1))) {
+    // 用空间网格求每个城市的 k 近邻, 多取一个再去掉城市自身
+    QList<SpatialGrid::Entry> entries;
+    entries.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        entries.append({coords.x[i], coords.y[i], i});
+    }
+    SpatialGrid grid;
+    grid.build(entries);
+
+    neighborList.assign(static_cast<size_t>(n) * k, 0);
+    neighborDist.assign(static_cast<size_t>(n) * k, 0);
+    for (int i = 0; i < n; ++i) {
+        QList<int> nearest = grid.nearest(coords.x[i], coords.y[i], k + 1);
+        int count = 0;
+        for (int j : nearest) {
+            if (j == i || count == k) continue;
+            neighborList[static_cast<size_t>(i) * k + count] = j;
+            neighborDist[static_cast<size_t>(i) * k + count] = dist(i, j);
+            count++;
+        }
+    }
+}
+
+// 最近邻法构造初始回路
+template <typename Tour>
+std::vector<int> LocalSearch<Tour>::nearestNeighborTour(int start) const {
+    std::vector<int> result;
+    if (n == 0) return result;
+    result.reserve(n);
+    std::vector<char> visited(n, 0);
+
+    // 未访问城市的空间索引, 候选邻居都已访问时用它找最近的未访问城市
+    QList<SpatialGrid::Entry> entries;
+    entries.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        entries.append({coords.x[i], coords.y[i], i});
+    }
+    SpatialGrid unvisited;
+    unvisited.build(entries);
+
+    int current = start;
+    visited[current] = 1;
+    unvisited.remove(current, coords.x[current], coords.y[current]);
+    result.push_back(current);
+
+    while (static_cast<int>(result.size()) < n) {
+        int nextCity = -1;
+        const int *candidates = neighbors(current);
+        for (int t = 0; t < k; ++t) {
+            if (!visited[candidates[t]]) {
+                nextCity = candidates[t];
+                break;
+            }
+        }
+        if (nextCity < 0) {
+            nextCity = unvisited.nearest(coords.x[current], coords.y[current], 1).first();
+        }
+        visited[nextCity] = 1;
+        unvisited.remove(nextCity, coords.x[nextCity], coords.y[nextCity]);
+        result.push_back(nextCity);
+        current = nextCity;
+    }
+    return result;
+}
+
+template <typename Tour>
+double LocalSearch<Tour>::tourLength(const std::vector<int> &tour) const {
+    double total = 0;
+    int size = static_cast<int>(tour.size());
+    for (int i = 0; i < size; ++i) {
+        total += dist(tour[i], tour[i + 1 == size ? 0 : i + 1]);
+    }
+    return total;
+}
+
+template <typename Tour>
+void LocalSearch<Tour>::push(int city) {
+    if (!queued[city]) {
+        queued[city] = 1;
+        queue.push_back(city);
+    }
+}
+
+// flip 可能翻转较短的另一侧, 之后回路方向不定, 每次按当前方向选择参数
+template <typename Tour>
+void LocalSearch<Tour>::reversePath(int p, int x, int y, int q) {
+    if (x == y) return;
+    if (tour.next(p) == x) {
+        tour.flip(p, x, y, q);
+    } else {
+        tour.flip(q, y, x, p);
+    }
+}
+
+// 片段 S 与它和插入点之间的部分 R 交换位置: 先把 S、R 整体翻转, 再把 R 翻回来, 得到 left 与 sL 相连;
+// 需要 left 与 s1 相连时再翻转一次片段
+template <typename Tour>
+void LocalSearch<Tour>::moveSegment(int p, int s1, int sL, int q, int left, int right, int x) {
+    if (right != p) {
+        // p S [q..left] right -> p [left..q] S' right -> p [q..left] S' right
+        reversePath(p, s1, left, right);
+        reversePath(p, left, q, sL);
+    } else {
+        // left [right..p] S q -> left S' [p..right] q -> left S' [right..p] q
+        reversePath(left, right, sL, q);
+        reversePath(s1, p, right, q);
+    }
+    if (x == s1) reversePath(left, sL, s1, right);
+}
+
+// 以 a 为端点的 2-opt: 删除 a 与后继(或前驱) b 的边, 改连候选邻居 c
+template <typename Tour>
+bool LocalSearch<Tour>::improveTwoOpt(int a) {
+    for (int dir = 0; dir < 2; ++dir) {
+        int b = dir == 0 ? tour.next(a) : tour.prev(a);
+        double dab = dist(a, b);
+        const int *candidates = neighbors(a);
+        const double *candidateDist = &neighborDist[static_cast<size_t>(a) * k];
+
+        for (int t = 0; t < k; ++t) {
+            double dac = candidateDist[t];
+            if (dac >= dab) break; // 新边不短于删掉的边, 后面的邻居更远
+            int c = candidates[t];
+            int d = dir == 0 ? tour.next(c) : tour.prev(c);
+            if (c == b || d == a) continue;
+
+            double delta = dac + dist(b, d) - dab - dist(c, d);
+            if (delta < -EPS) {
+                // 正向: a b ... c d -> a c ... b d; 反向: d c ... b a -> d b ... c a
+                if (dir == 0) {
+                    tour.flip(a, b, c, d);
+                } else {
+                    tour.flip(d, c, b, a);
+                }
+                push(a);
+                push(b);
+                push(c);
+                push(d);
+                stats.twoOptMoves++;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 以 a 为端点的 Or-opt: 取 a 开头或结尾的 1~3 个城市, 插到 a 的候选邻居 c 旁边
+template <typename Tour>
+bool LocalSearch<Tour>::improveOrOpt(int a) {
+    for (int length = 1; length <= 3 && length + 3 <= n; ++length) {
+        for (int role = 0; role < (length == 1 ? 1 : 2); ++role) {
+            // role 0: 片段为 a 及其后的城市; role 1: 片段以 a 结尾
+            int s1 = a, sL = a;
+            for (int t = 1; t < length; ++t) {
+                if (role == 0) {
+                    sL = tour.next(sL);
+                } else {
+                    s1 = tour.prev(s1);
+                }
+            }
+            int p = tour.prev(s1);
+            int q = tour.next(sL);
+            int other = a == s1 ? sL : s1;
+
+            // 取出片段后节省的长度
+            double removeGain = dist(p, s1) + dist(sL, q) - dist(p, q);
+            if (removeGain <= EPS) continue;
+
+            const int *candidates = neighbors(a);
+            const double *candidateDist = &neighborDist[static_cast<size_t>(a) * k];
+            for (int t = 0; t < k; ++t) {
+                double dac = candidateDist[t];
+                if (dac >= removeGain) break;
+                int c = candidates[t];
+                if (tour.between(s1, c, sL)) continue; // c 在片段内
+
+                // side 0 插在 c 与后继之间, side 1 插在前驱与 c 之间, 都让 a 与 c 相邻
+                for (int side = 0; side < 2; ++side) {
+                    int left = side == 0 ? c : tour.prev(c);
+                    int right = side == 0 ? tour.next(c) : c;
+                    if (tour.between(s1, left, sL)) continue; // 插入点在片段内
+                    if (left == p) continue;                   // 原位置
+
+                    int x = side == 0 ? a : other; // 与 left 相连的片段端点
+                    int y = side == 0 ? other : a; // 与 right 相连的片段端点
+                    double delta = dist(left, x) + dist(y, right) - dist(left, right) - removeGain;
+                    if (delta < -EPS) {
+                        moveSegment(p, s1, sL, q, left, right, x);
+                        push(p);
+                        push(q);
+                        push(s1);
+                        push(sL);
+                        push(left);
+                        push(right);
+                        stats.orOptMoves++;
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// 局部搜索主循环
+template <typename Tour>
+double LocalSearch<Tour>::optimize(std::vector<int> &route) {
+    QElapsedTimer timer;
+    timer.start();
+    stats = Stats();
+    stats.initialLength = tourLength(route);
+
+    if (n < 5 || static_cast<int>(route.size()) != n) {
+        stats.finalLength = stats.initialLength;
+        return stats.finalLength;
+    }
+
+    tour.init(route);
+
+    // 开始时所有城市都待检查, 按回路顺序入队
+    queue.clear();
+    queued.assign(n, 0);
+    for (int city : route) push(city);
+
+    while (!queue.empty() && !cancelled()) {
+        int a = queue.front();
+        queue.pop_front();
+        queued[a] = 0;
+        // 找到改进时 a 作为端点已重新入队, 否则保持 don't-look 状态
+        if (improveTwoOpt(a)) continue;
+        if (orOptEnabled) improveOrOpt(a);
+    }
+
+    route = tour.order();
+    stats.finalLength = tourLength(route);
+    stats.elapsedMs = timer.elapsed();
+    return stats.finalLength;
+}
+
+template class LocalSearch<ArrayTour>;
+template class LocalSearch<TwoLevelTour>;
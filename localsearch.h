@@ -0,0 +1,85 @@
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include "arraytour.h"
+#include "distancematrix.h"
+#include "twoleveltour.h"
+
+// 2-opt + Or-opt 局部搜索
+// 每个城市只与离它最近的 k 个城市尝试连新边, 新边比被删除的边还长时立即停止;
+// 没有找到改进的城市打上 don't-look 标记移出队列, 只有它相邻的边被修改时才重新检查,
+// 已经收敛的区域不会被反复扫描. 距离按坐标现算, 不需要 n*n 的距离矩阵, 可以处理上万个城市
+// Tour 为回路表示, 与 LinKernighan 相同: 2-opt 是一次 flip, Or-opt 由两到三次 flip 组成
+template <typename Tour = ArrayTour>
+class LocalSearch {
+public:
+    // 统计信息
+    struct Stats {
+        qint64 twoOptMoves = 0;   // 执行的 2-opt 次数
+        qint64 orOptMoves = 0;    // 执行的 Or-opt 次数
+        double initialLength = 0; // 优化前的回路长度
+        double finalLength = 0;   // 优化后的回路长度
+        qint64 elapsedMs = 0;     // 用时
+    };
+
+    // neighborCount 为每个城市的候选邻居数, 构造时用空间网格建立邻居表
+    // 坐标需在对象使用期间保持有效
+    explicit LocalSearch(const CityCoordinates &coords, int neighborCount = 10);
+
+    // 是否启用 Or-opt(把 1~3 个城市的片段移到别处), 默认启用
+    void setOrOptEnabled(bool enabled) { orOptEnabled = enabled; }
+
+    // 取消标志, 置位后 optimize() 尽快返回当前回路(仍是合法回路, 只是未到局部最优)
+    void setCancelFlag(const std::atomic<bool> *flag) { cancelFlag = flag; }
+
+    // 最近邻法构造初始回路, 优先在候选邻居中找, 都已访问时在未访问城市的空间网格中找最近的一个
+    std::vector<int> nearestNeighborTour(int start = 0) const;
+
+    // 把 tour(城市编号序列)就地改进到局部最优, 返回优化后的长度
+    double optimize(std::vector<int> &tour);
+
+    // 城市 city 的候选邻居, 按距离从近到远, 共 neighborCount() 个
+    const int *neighbors(int city) const { return &neighborList[static_cast<size_t>(city) * k]; }
+    int neighborCount() const { return k; }
+
+    double tourLength(const std::vector<int> &tour) const;
+    const Stats &lastStats() const { return stats; }
+
+private:
+    const CityCoordinates &coords;
+    int n;
+    int k;
+    bool orOptEnabled = true;
+    const std::atomic<bool> *cancelFlag = nullptr;
+
+    std::vector<int> neighborList;     // n * k 个候选邻居
+    std::vector<double> neighborDist;  // 对应的距离
+
+    Tour tour;
+    std::deque<int> queue; // 待检查的城市
+    std::vector<char> queued;
+    Stats stats;
+
+    double dist(int a, int b) const { return coords.distance(a, b); }
+    bool cancelled() const { return cancelFlag && cancelFlag->load(std::memory_order_relaxed); }
+
+    void push(int city);
+
+    // 删除 (p,x), (y,q), 加入 (p,y), (x,q): 翻转夹在 p 与 q 之间的路径 x..y, 不依赖回路方向
+    void reversePath(int p, int x, int y, int q);
+
+    // 把 p 与 q 之间的片段 s1..sL 移到 left 与 right 之间, left 与 x 相连(x 为 s1 或 sL)
+    void moveSegment(int p, int s1, int sL, int q, int left, int right, int x);
+
+    bool improveTwoOpt(int a);
+    bool improveOrOpt(int a);
+};
+
+extern template class LocalSearch<ArrayTour>;
+extern template class LocalSearch<TwoLevelTour>;
+
+#endif // LOCALSEARCH_H
@@ -3,6 +3,19 @@
 #include <QScreen>
 
 int main(int argc, char *argv[]) {
+    // 命令行转换, 不启动界面: TSPproblem --convert <输入文件> <输出文件>
+    // 扩展名为 .tspdb 的是数据库文件, 其余按文本文件处理
+    if (argc == 4 && qstrcmp(argv[1], "--convert") == 0) {
+        QCoreApplication app(argc, argv);
+        QStringList args = app.arguments();
+        QString error;
+        if (!CityManager::convertFile(args[2], args[3], &error)) {
+            qCritical().noquote() << "转换失败:" << error;
+            return 1;
+        }
+        return 0;
+    }
+
     QApplication a(argc, argv);
     a.setApplicationName("旅行商问题");
     a.setApplicationVersion("1.0");
@@ -3,140 +3,169 @@
 #include <QFile> // 文件流
 #include <QTextStream> // 文本数据流
 #include <cmath>
-#include <QGraphicsTextItem> // 文本框
+#include <limits>
+#include <QPainterPath>
+#include <QPixmapCache> // 城市层的绘制缓存
+#include <QRandomGenerator> // 随机算法的种子
+#include <QWheelEvent> // 滚轮缩放地图
 
 CityMapWidget::CityMapWidget(QWidget *parent) : QGraphicsView(parent) {
     scene = new QGraphicsScene(this);
     setScene(scene); // 使视图显示该场景的内容
     setRenderHint(QPainter::Antialiasing); // 启用抗锯齿渲染
     setBackgroundBrush(QBrush(Qt::white)); // 场景的背景为白色
+    setDragMode(QGraphicsView::ScrollHandDrag); // 按住鼠标拖动地图
+    // 不显示滚动条: 放大后滚动条出现会缩小视口并触发 resizeEvent, 视图又被恢复成完整视图; 拖动平移不受影响
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse); // 以鼠标位置为中心缩放
+
+    // 场景使用城市的世界坐标, 只把 y 轴反转; 缩放和平移交给视图变换, 窗口大小变化时不需要重建图形项
+    worldToScene = QTransform::fromScale(1, -1);
+
+    // 城市和回路各由一个图形项成批绘制, 场景里只有三个图形项, 不需要空间索引
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+    cityLayer = new CityLayerItem();
+    scene->addItem(cityLayer);
+    tourLayer = new TourLayerItem(); // 后加入, 画在城市上面
+    scene->addItem(tourLayer);
+
+    // 城市层缓存成一张视口大小的位图, 默认 10 MB 的位图缓存放不下全屏的大窗口
+    QPixmapCache::setCacheLimit(qMax(QPixmapCache::cacheLimit(), 64 * 1024));
+
+    // 距离线和范围圆; 画笔宽度按屏幕像素计算, 不随缩放变化
+    QPen pen(Qt::blue);
+    pen.setWidth(2);
+    pen.setCosmetic(true);
+    overlayItem = scene->addPath(QPainterPath(), pen);
+    overlayItem->setZValue(1);
+
+    // 实时回路每秒最多刷新 30 帧
+    frameTimer = new QTimer(this);
+    frameTimer->setInterval(33);
+    connect(frameTimer, &QTimer::timeout, this, &CityMapWidget::pullTourFrame);
 }
 
-// 依据给定的城市坐标信息，在图形场景里绘制城市以及它们之间的路径
+// 依据给定的城市坐标信息，在图形场景里绘制城市
+// 城市层按场景坐标重建抽稀索引, 回路保持不变
 void CityMapWidget::setCities(const QList<City>& cities) {
     this->cities = cities;
-    scene->clear();
-    cityItems.clear();
-
-    if (cities.isEmpty()) return;
-
-    // 计算坐标范围
-    double minX = cities[0].x, maxX = cities[0].x;
-    double minY = cities[0].y, maxY = cities[0].y;
 
+    CityCoordinates points;
+    points.x.reserve(cities.size());
+    points.y.reserve(cities.size());
+    QStringList names;
+    names.reserve(cities.size());
     for (const auto& city : cities) {
-        minX = qMin(minX, city.x);
-        maxX = qMax(maxX, city.x);
-        minY = qMin(minY, city.y);
-        maxY = qMax(maxY, city.y);
+        QPointF pos = worldToScene.map(QPointF(city.x, city.y));
+        points.append(pos.x(), pos.y());
+        names.append(city.name);
     }
+    cityLayer->setCities(points, names);
 
-    double width = maxX - minX;
-    double height = maxY - minY;
-
-    if (width <= 0) width = 1.0;
-    if (height <= 0) height = 1.0;
-
-    // 视图边距
-    double marginPercent = 0.1;
-    double viewWidth = this->width() * (1 - 2 * marginPercent);
-    double viewHeight = this->height() * (1 - 2 * marginPercent);
-
-    // 缩放比例
-    scale = qMin(viewWidth / width, viewHeight / height);
-
-    // 计算偏移量
-    double centerX = this->width() / 2;
-    double centerY = this->height() / 2;
-    double cityCenterX = (minX + maxX) / 2;
-    double cityCenterY = (minY + maxY) / 2;
-    offsetX = centerX - cityCenterX * scale;
-    offsetY = centerY - cityCenterY * scale;
-
-    // 绘制城市
-    for (const auto& city : cities) {
-        // 使用与路径相同的坐标变换公式
-        double x = city.x * scale + offsetX;
-        double y = city.y * scale + offsetY;
-
-        // y轴反转
-        y = this->height() - y;
-
-        // 绘制城市点
-        QGraphicsEllipseItem *cityItem =
-            scene->addEllipse(x-5, y-5, 10, 10, QPen(Qt::black), QBrush(Qt::red));
-        cityItems[city.name] = cityItem;
+    // 计算坐标范围
+    worldRect = QRectF();
+    if (!cities.isEmpty()) {
+        double minX = cities[0].x, maxX = cities[0].x;
+        double minY = cities[0].y, maxY = cities[0].y;
+
+        for (const auto& city : cities) {
+            minX = qMin(minX, city.x);
+            maxX = qMax(maxX, city.x);
+            minY = qMin(minY, city.y);
+            maxY = qMax(maxY, city.y);
+        }
 
-        // 绘制城市标签
-        QGraphicsTextItem *textItem = scene->addText(city.name);
-        textItem->setDefaultTextColor(Qt::black);
+        double width = maxX - minX;
+        double height = maxY - minY;
 
-        // 标签放在城市点上方，右侧对齐
-        double textX = x + 5;  // 右侧偏移
-        double textY = y - 20; // 上方偏移
+        if (width <= 0) width = 1.0;
+        if (height <= 0) height = 1.0;
 
-        textItem->setPos(textX, textY);
+        // 四周各留 10% 边距
+        double marginPercent = 0.1;
+        QRectF bounds((minX + maxX - width) / 2, (minY + maxY - height) / 2, width, height);
+        bounds.adjust(-width * marginPercent, -height * marginPercent, width * marginPercent, height * marginPercent);
+        worldRect = worldToScene.mapRect(bounds);
     }
 
-    // 绘制旅行商问题的路径
-    if (!path.isEmpty()) {
-        QPen pen(Qt::blue);
-        pen.setWidth(2);
-
-        for (int i = 0; i < path.size() - 1; ++i) {
-            double x1 = path[i].x * scale + offsetX;
-            double y1 = path[i].y * scale + offsetY;
-            double x2 = path[i+1].x * scale + offsetX;
-            double y2 = path[i+1].y * scale + offsetY;
-
-            // 应用 Y 轴反转
-            y1 = this->height() - y1;
-            y2 = this->height() - y2;
-
-            scene->addLine(x1, y1, x2, y2, pen);
-        }
-
+    fitToCities();
+}
 
-        // 绘制终点到起点的连线，使路径闭合
-        if (path.size() >= 2) {
-            double startX = path.first().x * scale + offsetX;
-            double startY = path.first().y * scale + offsetY;
-            double endX = path.last().x * scale + offsetX;
-            double endY = path.last().y * scale + offsetY;
+// 把全部城市缩放到视图中, 保持宽高比避免内容变形
+void CityMapWidget::fitToCities() {
+    if (worldRect.isEmpty()) return;
+    scene->setSceneRect(worldRect);
+    fitInView(worldRect, Qt::KeepAspectRatio);
+}
 
-            // 应用 Y 轴反转
-            startY = this->height() - startY;
-            endY = this->height() - endY;
+// 只替换回路, 城市点不动
+void CityMapWidget::setPath(const QList<City>& path) {
+    this->path = path;
+    overlayItem->setPath(QPainterPath());
 
-            scene->addLine(endX, endY, startX, startY, pen);
-        }
+    QPolygonF tour;
+    tour.reserve(path.size());
+    for (const auto& city : path) {
+        tour.append(worldToScene.map(QPointF(city.x, city.y)));
     }
+    tourLayer->setTour(tour);
+}
 
-    // 0, 0：场景的左上角坐标（原点）。
-    // this->width(), this->height()：场景的宽度和高度，通常取自当前窗口（this）的尺寸。
-    scene->setSceneRect(0, 0, this->width(), this->height());
-    fitInView(scene->sceneRect(), Qt::KeepAspectRatio); // 保持场景的宽高比，避免内容变形
+// 求解期间跟随实时回路
+void CityMapWidget::followTour(SolverControl *control) {
+    liveControl = control;
+    if (control) {
+        overlayItem->setPath(QPainterPath()); // 距离线和范围圆在求解开始时清除一次, 每帧只重绘回路层
+        frameTimer->start();
+        return;
+    }
+    frameTimer->stop();
+    setPath(path); // 恢复显示最后设置的路径
 }
 
-void CityMapWidget::setPath(const QList<City>& path) {
-    this->path = path;
-    setCities(cities); // 重新绘制地图和路径
+// 取一帧: 求解器没有发布新回路时什么也不做; 只替换回路层, 城市层、叠加层和视图不动
+void CityMapWidget::pullTourFrame() {
+    if (!liveControl || !liveControl->takeTour(frameOrder)) return;
+
+    QPolygonF tour;
+    tour.reserve(static_cast<int>(frameOrder.size()));
+    for (int index : frameOrder) {
+        if (index < 0 || index >= cities.size()) return; // 城市列表已变化, 丢弃这一帧
+        tour.append(worldToScene.map(QPointF(cities[index].x, cities[index].y)));
+    }
+    tourLayer->setTour(tour); // 城市层从缓存贴图
 }
 
 void CityMapWidget::clearPath() {
-    path.clear();
-    setCities(cities); // 清除路径(重新绘制地图，不包含路径)
+    setPath(QList<City>()); // 清除路径和距离线、范围圆
 }
 
 void CityMapWidget::resizeEvent(QResizeEvent *event) {
-    Q_UNUSED(event);
-    setCities(cities); // 窗口大小变化时重绘(包括城市和路径）
+    QGraphicsView::resizeEvent(event);
+    fitToCities(); // 窗口大小变化时只调整视图变换
+}
+
+// 滚轮缩放, 放大后可以拖动查看局部; 城市变化或窗口大小变化时恢复到完整视图
+void CityMapWidget::wheelEvent(QWheelEvent *event) {
+    double factor = std::pow(1.15, event->angleDelta().y() / 120.0);
+    scale(factor, factor);
+    event->accept();
 }
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     QWidget *centralWidget = new QWidget(this);
     setCentralWidget(centralWidget);
 
+    // 求解在后台线程进行, 界面线程定时取进度
+    solverService = new SolverService(&cityManager, this);
+    connect(solverService, &SolverService::progress, this, &MainWindow::onSolverProgress);
+    connect(solverService, &SolverService::logLines, this, &MainWindow::onSolverLog);
+    connect(solverService, &SolverService::finished, this, &MainWindow::onSolverFinished);
+
+    // 下拉框、补全和城市列表共用的城市数据
+    cityModel = new CityListModel(this);
+
     // 主程序大框架垂直布局
     QVBoxLayout *mainLayout = new QVBoxLayout(centralWidget);
     mapWidget = new CityMapWidget(this);
@@ -174,7 +203,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 
     QHBoxLayout *removeLayout = new QHBoxLayout();
     removeLayout->addWidget(new QLabel("删除城市:", this));
-    cityCombo1 = new QComboBox(this);
+    cityCombo1 = createCityCombo();
     removeLayout->addWidget(cityCombo1);
     QPushButton *removeButton = new QPushButton("删除", this);
     connect(removeButton, &QPushButton::clicked, this, &MainWindow::removeCity);
@@ -187,9 +216,13 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     QVBoxLayout *cityListLayout = new QVBoxLayout;
     cityListLayout->addWidget(new QLabel("城市列表:", this));
 
-    // 初始化城市列表控件
-    cityListWidget = new QListWidget(this);
-    cityListLayout->addWidget(cityListWidget);
+    // 初始化城市列表控件: 显示模型的第 1 列, 行高相同时不必逐行计算布局
+    cityListView = new QListView(this);
+    cityListView->setModel(cityModel);
+    cityListView->setModelColumn(CityListModel::DetailColumn);
+    cityListView->setUniformItemSizes(true);
+    cityListView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    cityListLayout->addWidget(cityListView);
     manageLayout->addLayout(cityListLayout);
 
     manageLayout->addLayout(cityListLayout);
@@ -205,11 +238,11 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     QHBoxLayout *distLayout = new QHBoxLayout();
 
     distLayout->addWidget(new QLabel("城市1:", this));
-    cityCombo2 = new QComboBox(this);
+    cityCombo2 = createCityCombo();
     distLayout->addWidget(cityCombo2);
 
     distLayout->addWidget(new QLabel("城市2:", this));
-    cityCombo3 = new QComboBox(this);
+    cityCombo3 = createCityCombo();
     distLayout->addWidget(cityCombo3);
 
     QPushButton *calcButton = new QPushButton("计算距离", this);
@@ -229,7 +262,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     QHBoxLayout *rangeQueryLayout = new QHBoxLayout();
     rangeQueryLayout->addWidget(new QLabel("中心城市:", this),0);
 
-    cityCombo4 = new QComboBox(this);
+    cityCombo4 = createCityCombo();
     rangeQueryLayout->addWidget(cityCombo4);
 
     rangeQueryLayout->addWidget(new QLabel("范围:", this));
@@ -253,10 +286,81 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     connect(tspButton, &QPushButton::clicked, this, &MainWindow::solveTSP);
     tspLayout->addWidget(tspButton);
 
+    QPushButton *parallelButton = new QPushButton("使用多线程穷举法计算最短路径(精确,利用全部CPU核心)", this);
+    connect(parallelButton, &QPushButton::clicked, this, &MainWindow::solveTSPParallel);
+    tspLayout->addWidget(parallelButton);
+
+    QPushButton *pruningButton = new QPushButton("使用剪枝穷举法计算最短路径(精确,固定起点并去除镜像路线)", this);
+    connect(pruningButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithPruning);
+    tspLayout->addWidget(pruningButton);
+
+    QPushButton *heldKarpButton = new QPushButton("使用动态规划(Held-Karp)计算最短路径(精确,适合25个城市以内)", this);
+    connect(heldKarpButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithHeldKarp);
+    tspLayout->addWidget(heldKarpButton);
+
+    QPushButton *branchAndBoundButton = new QPushButton("使用分支定界法计算最短路径(精确,适合60个城市以内)", this);
+    connect(branchAndBoundButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithBranchAndBound);
+    tspLayout->addWidget(branchAndBoundButton);
+
+    QPushButton *christofidesButton = new QPushButton("使用Christofides算法计算路径(1.5倍近似保证,很快)", this);
+    connect(christofidesButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithChristofides);
+    tspLayout->addWidget(christofidesButton);
+
+    QPushButton *localSearchButton = new QPushButton("使用局部搜索(2-opt/Or-opt)计算路径(很快,适合上万个城市)", this);
+    connect(localSearchButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithLocalSearch);
+    tspLayout->addWidget(localSearchButton);
+
+    QPushButton *linKernighanButton = new QPushButton("使用链式Lin-Kernighan计算路径(30秒,适合十万个城市以内)", this);
+    connect(linKernighanButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithLinKernighan);
+    tspLayout->addWidget(linKernighanButton);
+
+    // 模拟退火和并行回火的初始回路
+    QHBoxLayout *initialTourLayout = new QHBoxLayout();
+    initialTourLayout->addWidget(new QLabel("退火初始回路:", this));
+    initialTourCombo = new QComboBox(this);
+    for (TourConstruction::Method method : {TourConstruction::NearestNeighbor, TourConstruction::GreedyEdge,
+                                            TourConstruction::SpaceFillingCurve, TourConstruction::ConvexHullInsertion}) {
+        initialTourCombo->addItem(TourConstruction::methodName(method), method);
+    }
+    initialTourLayout->addWidget(initialTourCombo, 1);
+    tspLayout->addLayout(initialTourLayout);
+
     QPushButton *simulatedAnnealingButton = new QPushButton("使用模拟退火算法计算最短路径(较快,但可能不精确)",this);
     connect(simulatedAnnealingButton,&QPushButton::clicked,this,&MainWindow::solveTSPWithSimulatedAnnealing);
     tspLayout->addWidget(simulatedAnnealingButton);
 
+    QPushButton *parallelTemperingButton = new QPushButton("使用并行回火模拟退火计算路径(利用全部CPU核心,种子相同时结果可重现)", this);
+    connect(parallelTemperingButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithParallelTempering);
+    tspLayout->addWidget(parallelTemperingButton);
+
+    // 遗传算法的交叉算子
+    QHBoxLayout *crossoverLayout = new QHBoxLayout();
+    crossoverLayout->addWidget(new QLabel("遗传算法交叉算子:", this));
+    crossoverCombo = new QComboBox(this);
+    for (GeneticAlgorithm::Crossover crossover : {GeneticAlgorithm::EdgeAssembly, GeneticAlgorithm::Order}) {
+        crossoverCombo->addItem(GeneticAlgorithm::crossoverName(crossover), crossover);
+    }
+    crossoverLayout->addWidget(crossoverCombo, 1);
+    tspLayout->addLayout(crossoverLayout);
+
+    QPushButton *geneticButton = new QPushButton("使用岛屿模型遗传算法计算路径(30秒,每个CPU核心一个岛,适合聚集分布的城市)", this);
+    connect(geneticButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithGeneticAlgorithm);
+    tspLayout->addWidget(geneticButton);
+
+    QPushButton *antColonyButton = new QPushButton("使用MAX-MIN蚁群算法计算路径(30秒,利用全部CPU核心)", this);
+    connect(antColonyButton, &QPushButton::clicked, this, &MainWindow::solveTSPWithAntColony);
+    tspLayout->addWidget(antColonyButton);
+
+    // 停止按钮和进度, 取消后显示求解器目前找到的最优路径
+    QHBoxLayout *solverStatusLayout = new QHBoxLayout();
+    cancelButton = new QPushButton("停止求解", this);
+    cancelButton->setEnabled(false);
+    connect(cancelButton, &QPushButton::clicked, this, &MainWindow::cancelSolver);
+    solverStatusLayout->addWidget(cancelButton);
+    solverStatusLabel = new QLabel("空闲", this);
+    solverStatusLayout->addWidget(solverStatusLabel, 1);
+    tspLayout->addLayout(solverStatusLayout);
+
     // 日志显示区域
     logTextEdit = new QTextEdit(this);
     logTextEdit->setReadOnly(true);
@@ -293,11 +397,20 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 
     tabWidget->addTab(aboutTab,"关于");
 
+    // 求解期间禁用的控件: 所有求解按钮和选项, 以及会修改城市的选项卡
+    solverWidgets = {tspButton, parallelButton, pruningButton, heldKarpButton, branchAndBoundButton,
+                     christofidesButton, localSearchButton, linKernighanButton, initialTourCombo,
+                     simulatedAnnealingButton, parallelTemperingButton, crossoverCombo, geneticButton,
+                     antColonyButton, manageTab, fileTab};
+
     // 加载初始城市数据
     loadFromFile();
 }
 
 MainWindow::~MainWindow() {
+    // 后台线程还在使用 cityManager, 必须在成员析构之前结束
+    mapWidget->followTour(nullptr);
+    solverService->cancelAndWait();
 }
 
 void MainWindow::addCity() {
@@ -321,22 +434,7 @@ void MainWindow::addCity() {
         xCoordEdit->clear();
         yCoordEdit->clear();
 
-        // 更新下拉列表
-        cityCombo1->clear();
-        cityCombo2->clear();
-        cityCombo3->clear();
-        cityCombo4->clear();
-        Q_FOREACH (const auto& c, cityManager.getAllCities()) {
-            cityCombo1->addItem(c.name);
-            cityCombo2->addItem(c.name);
-            cityCombo3->addItem(c.name);
-            cityCombo4->addItem(c.name);
-        }
-
-        // 更新地图
-        mapWidget->clearPath();
-        mapWidget->setCities(cityManager.getAllCities());
-        updateCityList(); // 更新城市列表
+        updateCityList(); // 更新下拉列表、城市列表和地图
         QMessageBox::information(this, "成功", "城市添加成功");
     } else {
         QMessageBox::warning(this, "失败", "城市添加失败，可能名称已存在");
@@ -348,22 +446,7 @@ void MainWindow::removeCity() {
     if (name.isEmpty()) return;
 
     if (cityManager.removeCity(name)) {
-        // 更新下拉列表
-        cityCombo1->clear();
-        cityCombo2->clear();
-        cityCombo3->clear();
-        cityCombo4->clear();
-        Q_FOREACH (const auto& c, cityManager.getAllCities()) {
-            cityCombo1->addItem(c.name);
-            cityCombo2->addItem(c.name);
-            cityCombo3->addItem(c.name);
-            cityCombo4->addItem(c.name);
-        }
-
-        // 更新地图
-        mapWidget->clearPath();
-        mapWidget->setCities(cityManager.getAllCities());
-        updateCityList(); // 更新城市列表
+        updateCityList(); // 更新下拉列表、城市列表和地图
         QMessageBox::information(this, "成功", "城市删除成功");
     } else {
         QMessageBox::warning(this, "失败", "城市删除失败");
@@ -390,19 +473,10 @@ void MainWindow::calculateDistance() {
 
 void CityMapWidget::drawDistanceLine(const City &city1,const City &city2){
     clearPath();
-    double startX = city1.x * scale + offsetX;
-    double startY = city1.y * scale + offsetY;
-    double endX = city2.x * scale + offsetX;
-    double endY = city2.y * scale + offsetY;
-
-    // 应用 Y 轴反转
-    startY = this->height() - startY;
-    endY = this->height() - endY;
-
-    QPen pen(Qt::blue);
-    pen.setWidth(2);
-    setCities(cities);
-    scene->addLine(endX, endY, startX, startY, pen);
+    QPainterPath line;
+    line.moveTo(city1.x, city1.y);
+    line.lineTo(city2.x, city2.y);
+    overlayItem->setPath(worldToScene.map(line));
 }
 
 
@@ -444,21 +518,112 @@ void MainWindow::findCitiesInRange() {
 
 void CityMapWidget::drawRangeCircle(const City&center,double range){
     clearPath();
-    double circleX = center.x * scale + offsetX;
-    double circleY = center.y * scale + offsetY;
+    QPainterPath circle;
+    circle.addEllipse(QPointF(center.x, center.y), range, range);
+    overlayItem->setPath(worldToScene.map(circle));
+}
 
-    circleY = this->height() - circleY;
+namespace {
 
-    double circleRadius = range * scale;
-    QPen pen(Qt::blue);
-    pen.setWidth(2);
-    scene->addEllipse(
-        circleX - circleRadius,
-        circleY - circleRadius,
-        2 * circleRadius,
-        2 * circleRadius,
-        pen
-        );
+// 常规步骤的日志最小间隔(毫秒), 间隔内的常规步骤不构造也不显示
+const qint64 LOG_INTERVAL_MS = 50;
+
+// 日志接收端: 在后台线程把步骤格式化成一行交给求解服务, 界面线程定时取走显示
+template <typename Step, typename Format>
+CallbackSink<Step> logSink(SolverService *service, Format format) {
+    CallbackSink<Step> sink([service, format](const Step& step) {
+        service->appendLog(format(step));
+    });
+    sink.setMinInterval(LOG_INTERVAL_MS);
+    return sink;
+}
+
+// 穷举法日志
+QString bruteForceLine(const BruteForceStep& step) {
+    return QString("[%1/%2] %3 | 距离: %4")
+        .arg(step.iteration)
+        .arg(CityManager::permutationCountText(step.totalPermutations))
+        .arg(step.message)
+        .arg(step.currentDistance, 8, 'f', 3);
+}
+
+} // namespace
+
+// 在后台线程运行求解任务, 求解期间禁止修改城市, 地图仍可拖动和缩放
+void MainWindow::startSolver(SolverService::Job job) {
+    if (!solverService->start(job)) return;
+    mapWidget->followTour(solverService->solverControl());
+    setSolverRunning(true);
+    solverStatusLabel->setText("正在求解...");
+}
+
+void MainWindow::setSolverRunning(bool running) {
+    for (QWidget *widget : solverWidgets) {
+        widget->setEnabled(!running);
+    }
+    cancelButton->setEnabled(running);
+}
+
+void MainWindow::cancelSolver() {
+    solverService->cancel();
+    cancelButton->setEnabled(false);
+    solverStatusLabel->setText("正在停止, 等待求解器返回目前最优路径...");
+}
+
+void MainWindow::onSolverProgress(double distance, const QString& message, qint64 elapsedMs) {
+    QString text = QString("[%1 s] ").arg(elapsedMs / 1000.0, 0, 'f', 1);
+    if (distance > 0 && distance < std::numeric_limits<double>::max()) {
+        text += QString("目前最优: %1 | ").arg(distance, 0, 'f', 3);
+    }
+    solverStatusLabel->setText(text + message);
+}
+
+void MainWindow::onSolverLog(const QStringList& lines) {
+    for (const QString& line : lines) {
+        logTextEdit->append(line);
+    }
+}
+
+void MainWindow::onSolverFinished(const SolverService::Result& result) {
+    mapWidget->followTour(nullptr);
+    setSolverRunning(false);
+    solverStatusLabel->setText(QString("%1, 用时 %2 ms")
+                                   .arg(result.cancelled ? "已取消" : "求解结束")
+                                   .arg(result.elapsedMs));
+
+    if (result.cancelled) {
+        logTextEdit->append("求解已取消，显示目前找到的最优路径");
+    }
+
+    if (!result.path.isEmpty()) {
+        mapWidget->setPath(result.path);
+        double totalDistance = cityManager.calculateTotalDistance(result.path);
+        logTextEdit->append("\n=== 最终结果 ===");
+        logTextEdit->append(QString("路径长度: %1, 用时 %2 ms").arg(totalDistance).arg(result.elapsedMs));
+        if (!result.summary.isEmpty()) {
+            QMessageBox::information(this, "求解结果", result.summary);
+        }
+    } else {
+        QString reason = result.failure.isEmpty() ? QString("无法找到有效的路径") : result.failure;
+        logTextEdit->append("求解失败，" + reason);
+        if (!result.cancelled) {
+            QMessageBox::warning(this, "求解失败", reason);
+        }
+    }
+}
+
+// 闭合路径的弹窗内容
+QString MainWindow::describeClosedPath(const QList<City>& path) {
+    QString pathStr = "最优路径（闭合回路）:\n";
+    for (int i = 0; i < path.size() - 1; ++i) {  // 减去1以避免重复显示起点
+        pathStr += QString("%1. %2\n").arg(i+1).arg(path[i].name);
+    }
+    pathStr += QString("%1. %2（回到起点）\n").arg(path.size()).arg(path.last().name);
+
+    // 计算总距离（包含回到起点）
+    double totalDistance = cityManager.calculateTotalDistance(path);
+    pathStr += QString("\n总距离: %1").arg(totalDistance);
+    return pathStr;
 }
 
 void MainWindow::solveTSP() {
@@ -471,39 +636,171 @@ void MainWindow::solveTSP() {
     logTextEdit->clear();
     logTextEdit->append("穷举法求解开始...");
 
-    // 收集步骤
-    QList<BruteForceStep> steps;
-    QList<City> path = cityManager.solveTSP(&steps);
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<BruteForceStep>(solverService, bruteForceLine);
+        result.path = cityManager.solveTSP(&steps);
+        if (!result.path.isEmpty()) result.summary = describeClosedPath(result.path);
+    });
+}
+
+void MainWindow::solveTSPParallel() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市来求解旅行商问题");
+        return;
+    }
+
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("多线程穷举法求解开始...");
+
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<BruteForceStep>(solverService, bruteForceLine);
+        result.path = cityManager.solveTSPParallel(&steps);
+        if (!result.path.isEmpty()) result.summary = describeClosedPath(result.path);
+    });
+}
 
-    // 显示每一步日志
-    Q_FOREACH (const auto& step, steps) {
-        QString logLine = QString("[%1/%2] %3 | 距离: %4")
-                              .arg(step.iteration)
-                              .arg(step.totalPermutations)
-                              .arg(step.message)
-                              .arg(step.currentDistance, 8, 'f', 3);
-        logTextEdit->append(logLine);
+void MainWindow::solveTSPWithPruning() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市来求解旅行商问题");
+        return;
     }
 
-    if (!path.isEmpty()) {
-        mapWidget->setPath(path);
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("剪枝穷举法求解开始...");
+
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<BruteForceStep>(solverService, bruteForceLine);
+        result.path = cityManager.solveTSPWithPruning(&steps);
+        if (!result.path.isEmpty()) result.summary = describeClosedPath(result.path);
+    });
+}
+
+void MainWindow::solveTSPWithHeldKarp() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市来求解旅行商问题");
+        return;
+    }
+
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("动态规划(Held-Karp)求解开始...");
+
+    startSolver([this](SolverService::Result& result) {
+        QString lastMessage;
+        auto steps = logSink<HeldKarpStep>(solverService, [&lastMessage](const HeldKarpStep& step) {
+            lastMessage = step.message;
+            return QString("[%1/%2] %3")
+                .arg(step.processedSubsets)
+                .arg(step.totalSubsets)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithHeldKarp(&steps);
+
+        if (!result.path.isEmpty()) {
+            result.summary = describeClosedPath(result.path);
+        } else {
+            // 超出内存上限时最后一条日志说明原因
+            result.failure = lastMessage;
+        }
+    });
+}
+
+void MainWindow::solveTSPWithBranchAndBound() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市来求解旅行商问题");
+        return;
+    }
 
-        // 构建路径字符串（包含回到起点）
-        QString pathStr = "最优路径（闭合回路）:\n";
-        for (int i = 0; i < path.size() - 1; ++i) {  // 减去1以避免重复显示起点
-            pathStr += QString("%1. %2\n").arg(i+1).arg(path[i].name);
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("分支定界法求解开始...");
+
+    startSolver([this](SolverService::Result& result) {
+        double gap = 0;
+        auto steps = logSink<BranchAndBoundStep>(solverService, [&gap](const BranchAndBoundStep& step) {
+            gap = step.gap;
+            return QString("[%1] 下界=%2 | 上界=%3 | %4")
+                .arg(step.nodes, 6)
+                .arg(step.lowerBound, 8, 'f', 3)
+                .arg(step.upperBound, 8, 'f', 3)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithBranchAndBound(&steps);
+
+        if (!result.path.isEmpty()) {
+            result.summary = describeClosedPath(result.path);
+            if (gap > 0) {
+                result.summary += QString("\n距最优的差距不超过: %1%").arg(gap * 100, 0, 'f', 3);
+            }
         }
-        pathStr += QString("%1. %2（回到起点）\n").arg(path.size()).arg(path.last().name);
+    });
+}
 
-        // 计算总距离（包含回到起点）
-        double totalDistance = cityManager.calculateTotalDistance(path);
-        pathStr += QString("\n总距离: %1").arg(totalDistance);
+void MainWindow::solveTSPWithChristofides() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市");
+        return;
+    }
 
-        QMessageBox::information(this, "求解结果", pathStr);
-    } else {
-        logTextEdit->append("求解失败，无法找到有效的路径");
-        QMessageBox::warning(this, "求解失败", "无法找到有效的路径");
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("Christofides 算法开始...");
+
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<ChristofidesStep>(solverService, [](const ChristofidesStep& step) {
+            return QString("[%1 ms] 下界=%2 | %3")
+                .arg(step.elapsedMs, 6)
+                .arg(step.lowerBound, 8, 'f', 3)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithChristofides(&steps);
+    });
+}
+
+void MainWindow::solveTSPWithLocalSearch() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市");
+        return;
     }
+
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("局部搜索开始...");
+
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<LocalSearchStep>(solverService, [](const LocalSearchStep& step) {
+            return QString("[2-opt %1 | Or-opt %2 | %3 ms] 距离=%4 | %5")
+                .arg(step.twoOptMoves)
+                .arg(step.orOptMoves)
+                .arg(step.elapsedMs)
+                .arg(step.distance, 8, 'f', 3)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithLocalSearch(&steps);
+    });
+}
+
+void MainWindow::solveTSPWithLinKernighan() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市");
+        return;
+    }
+
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("链式 Lin-Kernighan 开始...");
+
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<LinKernighanStep>(solverService, [](const LinKernighanStep& step) {
+            return QString("[%1 ms] 距离=%2 | %3")
+                .arg(step.elapsedMs, 6)
+                .arg(step.distance, 8, 'f', 3)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithLinKernighan(&steps);
+    });
 }
 
 void MainWindow::solveTSPWithSimulatedAnnealing() {
@@ -516,99 +813,214 @@ void MainWindow::solveTSPWithSimulatedAnnealing() {
     logTextEdit->clear();
     logTextEdit->append("模拟退火算法开始...");
 
-    // 收集步骤
-    QList<AnnealingStep> steps;
-    QList<City> path = cityManager.solveTSPWithSimulatedAnnealing(&steps);
-
-    // 显示每一步
-    for (const auto& step : steps) {
-        QString logLine = QString("[%1] T=%2 | 当前路径=%3 | 最优路径=%4 | %5")
-                              .arg(step.iteration, 4)
-                              .arg(step.temperature, 8, 'f', 3)
-                              .arg(step.currentEnergy, 8, 'f', 3)
-                              .arg(step.bestEnergy, 8, 'f', 3)
-                              .arg(step.message);
+    // 每次求解换一个种子, 种子记入日志, 用 setRandomSeed 设回同一种子可以复现结果
+    cityManager.setRandomSeed(QRandomGenerator::global()->generate64());
+    cityManager.setInitialTourMethod(static_cast<TourConstruction::Method>(initialTourCombo->currentData().toInt()));
+    logTextEdit->append(QString("随机种子: %1, 初始回路: %2")
+                            .arg(cityManager.getRandomSeed())
+                            .arg(initialTourCombo->currentText()));
+
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<AnnealingStep>(solverService, [](const AnnealingStep& step) {
+            return QString("[%1] T=%2 | 当前路径=%3 | 最优路径=%4 | %5")
+                .arg(step.iteration, 4)
+                .arg(step.temperature, 8, 'f', 3)
+                .arg(step.currentEnergy, 8, 'f', 3)
+                .arg(step.bestEnergy, 8, 'f', 3)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithSimulatedAnnealing(&steps);
+
+        if (!result.path.isEmpty()) {
+            QString pathInfo = "最优路径:\n";
+            for (int i = 0; i < result.path.size(); ++i) {
+                pathInfo += QString("%1. %2\n").arg(i + 1).arg(result.path[i].name);
+            }
+            pathInfo += QString("\n总距离: %1").arg(cityManager.calculateTotalDistance(result.path));
+            result.summary = pathInfo;
+        }
+    });
+}
 
-        logTextEdit->append(logLine);
+void MainWindow::solveTSPWithParallelTempering() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市");
+        return;
     }
 
-    double totalDistance = cityManager.calculateTotalDistance(path);
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("并行回火模拟退火开始...");
+
+    // 种子记入日志, 用同一种子可以复现结果
+    cityManager.setRandomSeed(QRandomGenerator::global()->generate64());
+    cityManager.setInitialTourMethod(static_cast<TourConstruction::Method>(initialTourCombo->currentData().toInt()));
+    logTextEdit->append(QString("初始回路: %1").arg(initialTourCombo->currentText()));
+
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<AnnealingStep>(solverService, [](const AnnealingStep& step) {
+            return QString("[%1] T=%2 | 最冷链=%3 | 最优路径=%4 | %5")
+                .arg(step.iteration, 4)
+                .arg(step.temperature, 8, 'f', 3)
+                .arg(step.currentEnergy, 8, 'f', 3)
+                .arg(step.bestEnergy, 8, 'f', 3)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithParallelTempering(&steps);
+    });
+}
 
-    QString pathInfo = "最优路径:\n";
-    for (int i = 0; i < path.size(); ++i) {
-        pathInfo += QString("%1. %2\n")
-        .arg(i + 1)
-            .arg(path[i].name);
+void MainWindow::solveTSPWithGeneticAlgorithm() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市");
+        return;
     }
-    pathInfo += QString("\n总距离: %1").arg(totalDistance);
 
-    // 显示最终结果
-    if (!path.isEmpty()) {
-        mapWidget->setPath(path);
-        logTextEdit->append("\n=== 最终结果 ===");
-        logTextEdit->append(QString("最优路径长度: %1").arg(totalDistance));
-        QMessageBox::information(this, "求解结果", pathInfo);
-    } else {
-        logTextEdit->append("求解失败，无法找到有效路径");
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("遗传算法开始...");
+
+    // 种子记入日志, 用同一种子可以复现结果
+    cityManager.setRandomSeed(QRandomGenerator::global()->generate64());
+    auto crossover = static_cast<GeneticAlgorithm::Crossover>(crossoverCombo->currentData().toInt());
+
+    startSolver([this, crossover](SolverService::Result& result) {
+        auto steps = logSink<GeneticStep>(solverService, [](const GeneticStep& step) {
+            return QString("[%1] 最优个体=%2 | 平均=%3 | %4")
+                .arg(step.generation, 4)
+                .arg(step.bestDistance, 8, 'f', 3)
+                .arg(step.averageDistance, 8, 'f', 3)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithGeneticAlgorithm(&steps, crossover);
+    });
+}
+
+void MainWindow::solveTSPWithAntColony() {
+    if (cityManager.getCityCount() < 2) {
+        QMessageBox::information(this, "提示", "至少需要两个城市");
+        return;
     }
+
+    // 清空日志
+    logTextEdit->clear();
+    logTextEdit->append("蚁群算法开始...");
+
+    // 种子记入日志, 用同一种子可以复现结果
+    cityManager.setRandomSeed(QRandomGenerator::global()->generate64());
+
+    startSolver([this](SolverService::Result& result) {
+        auto steps = logSink<AntColonyStep>(solverService, [](const AntColonyStep& step) {
+            return QString("[%1] 本轮最优=%2 | 最优路径=%3 | 信息素 [%4, %5] | %6")
+                .arg(step.iteration, 4)
+                .arg(step.iterationBest, 8, 'f', 3)
+                .arg(step.bestDistance, 8, 'f', 3)
+                .arg(step.tauMin, 0, 'g', 3)
+                .arg(step.tauMax, 0, 'g', 3)
+                .arg(step.message);
+        });
+        result.path = cityManager.solveTSPWithAntColony(&steps);
+    });
 }
 
 void MainWindow::loadFromFile() {
-    QString fileName = QFileDialog::getOpenFileName(this, "打开城市文件", "", "文本文件 (*.txt)");
+    QString fileName = QFileDialog::getOpenFileName(this, "打开城市文件", "",
+                                                    "城市文件 (*.txt *.tspdb);;文本文件 (*.txt);;城市数据库 (*.tspdb)");
     if (fileName.isEmpty()) return;
 
-    if (cityManager.loadFromFile(fileName)) {
-        QMessageBox::information(this, "成功", "文件加载成功");
-
-        // 更新下拉列表
-        cityCombo1->clear();
-        cityCombo2->clear();
-        cityCombo3->clear();
-        cityCombo4->clear();
-        Q_FOREACH (const auto& c, cityManager.getAllCities()) {
-            cityCombo1->addItem(c.name);
-            cityCombo2->addItem(c.name);
-            cityCombo3->addItem(c.name);
-            cityCombo4->addItem(c.name);
+    if (fileName.endsWith(".tspdb", Qt::CaseInsensitive)) {
+        // 数据库文件只映射不解析, 打开失败时保留现有城市
+        QString error;
+        if (!cityManager.openDatabase(fileName, &error)) {
+            QMessageBox::warning(this, "失败", "数据库打开失败: " + error);
+            return;
         }
-
-        // 设置 cityCombo3 的初始值为 cityCombo2 的下一个城市
-        if (cityCombo2->count() > 1) { // 确保有足够的城市
-            int nextIndex = (cityCombo2->currentIndex() + 1) % cityCombo2->count();
-            cityCombo3->setCurrentIndex(nextIndex);
+        QMessageBox::information(this, "成功", QString("数据库打开成功, 共 %1 个城市").arg(cityManager.getCityCount()));
+    } else {
+        CityFileReport report;
+        if (!cityManager.loadFromFile(fileName, &report)) {
+            QMessageBox::warning(this, "失败", "文件加载失败");
+            return;
+        }
+        if (report.issueCount() == 0) {
+            QMessageBox::information(this, "成功", QString("文件加载成功, 共 %1 个城市").arg(report.cityCount));
+        } else {
+            // 列出前几条有问题的行
+            QString text = QString("已加载 %1 个城市, 跳过 %2 行:").arg(report.cityCount).arg(report.issueCount());
+            for (int kind = CityFileIssue::MissingFields; kind <= CityFileIssue::DuplicateName; ++kind) {
+                if (report.issueCounts[kind] > 0) {
+                    text += QString("\n    %1: %2 行")
+                                .arg(CityFileReport::kindName(static_cast<CityFileIssue::Kind>(kind)))
+                                .arg(report.issueCounts[kind]);
+                }
+            }
+            for (int i = 0; i < report.issues.size() && i < 10; ++i) {
+                const CityFileIssue& issue = report.issues[i];
+                text += QString("\n第 %1 行 (%2): %3")
+                            .arg(issue.line).arg(CityFileReport::kindName(issue.kind)).arg(issue.text);
+            }
+            if (report.issueCount() > 10) {
+                text += "\n...";
+            }
+            QMessageBox::warning(this, "部分行未加载", text);
         }
+    }
 
-        // 更新地图
-        mapWidget->clearPath();
-        mapWidget->setCities(cityManager.getAllCities());
-        updateCityList(); // 更新城市列表
-    } else {
-        QMessageBox::warning(this, "失败", "文件加载失败");
+    updateCityList(); // 更新下拉列表、城市列表和地图
+
+    // 设置 cityCombo3 的初始值为 cityCombo2 的下一个城市
+    if (cityCombo2->count() > 1) { // 确保有足够的城市
+        int nextIndex = (cityCombo2->currentIndex() + 1) % cityCombo2->count();
+        cityCombo3->setCurrentIndex(nextIndex);
     }
 }
 
 void MainWindow::saveToFile() {
-    QString fileName = QFileDialog::getSaveFileName(this, "保存城市文件", "", "文本文件 (*.txt)");
+    QString fileName = QFileDialog::getSaveFileName(this, "保存城市文件", "",
+                                                    "文本文件 (*.txt);;城市数据库 (*.tspdb)");
     if (fileName.isEmpty()) return;
 
-    if (cityManager.saveToFile(fileName)) {
+    // 按扩展名选择格式
+    bool saved;
+    QString error;
+    if (fileName.endsWith(".tspdb", Qt::CaseInsensitive)) {
+        saved = cityManager.saveDatabase(fileName, &error);
+    } else {
+        saved = cityManager.saveToFile(fileName);
+    }
+    if (saved) {
         QMessageBox::information(this, "成功", "文件保存成功");
     } else {
-        QMessageBox::warning(this, "失败", "文件保存失败");
+        QMessageBox::warning(this, "失败", error.isEmpty() ? QString("文件保存失败") : "文件保存失败: " + error);
     }
 }
 
+// 城市增删或重新加载后刷新: 只取一次全部城市, 下拉框和城市列表通过模型重置, 不逐项添加
 void MainWindow::updateCityList()
 {
-    cityListWidget->clear(); // 先清空原有内容
-    // 从 cityManager 获取所有城市数据
     QList<City> allCities = cityManager.getAllCities();
-    Q_FOREACH (const auto& city, allCities) {
-        // 拼接城市名、x、y 坐标为字符串，格式如“城市名 x:100 y:200”
-        QString cityInfo = QString("%1 x:%2 y:%3")
-                               .arg(city.name)
-                               .arg(city.x)
-                               .arg(city.y);
-        cityListWidget->addItem(cityInfo);
+    cityModel->setCities(allCities);
+    mapWidget->clearPath();
+    mapWidget->setCities(allCities);
+}
+
+// 城市下拉框: 使用共用的城市模型, 可以输入城市名并按包含关系补全;
+// 宽度不按内容计算, 城市很多时不逐项测量文字宽度
+QComboBox *MainWindow::createCityCombo()
+{
+    QComboBox *combo = new QComboBox(this);
+    combo->setModel(cityModel);
+    combo->setEditable(true);
+    combo->setInsertPolicy(QComboBox::NoInsert);
+    combo->setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLengthWithIcon);
+    combo->setMinimumContentsLength(12);
+    if (QListView *view = qobject_cast<QListView*>(combo->view())) {
+        view->setUniformItemSizes(true);
     }
+
+    QCompleter *completer = new QCompleter(cityModel, combo);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    completer->setFilterMode(Qt::MatchContains);
+    combo->setCompleter(completer);
+    return combo;
 }
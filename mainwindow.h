@@ -4,16 +4,24 @@
 #include <QMainWindow>  // 主窗口的基础框架
 #include <QGraphicsView>  // 是一个可滚动的视口，适合展示复杂的二维图形
 #include <QGraphicsScene> // 管理大量的 2D 图形项
+#include <QGraphicsPathItem> // 距离线和范围圆
+#include <QTransform> // 城市坐标到场景坐标的变换
+#include <QTimer>
 #include <QPushButton> // 创建可点击的按钮
 #include <QVBoxLayout> // 垂直排列界面元素，比如按钮、标签等
 #include <QHBoxLayout> // 水平排列界面元素
 #include <QLineEdit> // 单行文本输入框
 #include <QLabel>  // 静态文本或者图像
 #include <QComboBox> // 下拉选择框
-#include <QListWidget> // 列表
+#include <QListView> // 城市列表
+#include <QCompleter> // 按输入补全城市名
 #include <QTextEdit>
 #include <QFileDialog> // 文件选择对话框
+#include "citylayeritem.h"
+#include "citylistmodel.h"
+#include "tourlayeritem.h"
 #include "citymanager.h"
+#include "solverservice.h"
 
 class CityMapWidget : public QGraphicsView {
     Q_OBJECT
@@ -25,18 +33,30 @@ public:
     void drawDistanceLine(const City &city1,const City &city2);
     void drawRangeCircle(const City &center,double range);
 
+    // 求解期间按固定帧率从控制块取最新回路显示; control 为空时停止, 恢复显示 setPath() 设置的路径
+    void followTour(SolverControl *control);
+
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
 
+private slots:
+    void pullTourFrame();
 
 private:
-    double scale;
-    double offsetX;
-    double offsetY;
+    void fitToCities();
+
     QGraphicsScene *scene;
+    QTransform worldToScene;   // 城市坐标到场景坐标(y 轴反转)
+    QRectF worldRect;          // 全部城市加边距在场景中的范围
+    CityLayerItem *cityLayer;       // 城市点和标签
+    TourLayerItem *tourLayer;       // 回路
+    QGraphicsPathItem *overlayItem; // 距离线和范围圆
     QList<City> cities;
     QList<City> path;
-    QMap<QString, QGraphicsEllipseItem*> cityItems;
+    SolverControl *liveControl = nullptr; // 正在显示其实时回路的求解控制块
+    QTimer *frameTimer;
+    std::vector<int> frameOrder;          // 取回路用的缓冲区, 与控制块轮换复用
 
 };
 
@@ -52,17 +72,48 @@ private slots:
     void calculateDistance();
     void findCitiesInRange();
     void solveTSP();
+    void solveTSPParallel();
+    void solveTSPWithPruning();
+    void solveTSPWithHeldKarp();
+    void solveTSPWithBranchAndBound();
+    void solveTSPWithChristofides();
+    void solveTSPWithLocalSearch();
+    void solveTSPWithLinKernighan();
     void solveTSPWithSimulatedAnnealing();
+    void solveTSPWithParallelTempering();
+    void solveTSPWithGeneticAlgorithm();
+    void solveTSPWithAntColony();
+    void cancelSolver();
+    void onSolverProgress(double distance, const QString& message, qint64 elapsedMs);
+    void onSolverLog(const QStringList& lines);
+    void onSolverFinished(const SolverService::Result& result);
     void loadFromFile();
     void saveToFile();
     void updateCityList();
 
 private:
+    // 在后台线程开始求解, 求解期间禁用求解按钮和修改城市的控件
+    void startSolver(SolverService::Job job);
+    void setSolverRunning(bool running);
+
+    // 创建使用城市模型的下拉框
+    QComboBox *createCityCombo();
+
+    // 闭合路径的弹窗内容: 逐个列出城市和总距离
+    QString describeClosedPath(const QList<City>& path);
+
     CityManager cityManager;
     CityMapWidget *mapWidget;
     QLineEdit *cityNameEdit, *xCoordEdit, *yCoordEdit, *rangeEdit; // 文本输入框
     QComboBox *cityCombo1, *cityCombo2, *cityCombo3, *cityCombo4; // 城市下拉选择框
-    QListWidget *cityListWidget; // 城市列表
+    QComboBox *initialTourCombo; // 模拟退火的初始回路构造方法
+    QComboBox *crossoverCombo;   // 遗传算法的交叉算子
+    CityListModel *cityModel;    // 下拉框和城市列表共用的城市数据
+    QListView *cityListView;     // 城市列表
+    SolverService *solverService; // 后台求解
+    QPushButton *cancelButton;    // 停止求解
+    QLabel *solverStatusLabel;    // 求解进度
+    QList<QWidget*> solverWidgets; // 求解期间禁用的控件
     QLabel *statusLabel,*statusLabel2;
     QTextEdit *logTextEdit;
 };
@@ -0,0 +1,89 @@
+#include "pointpyramid.h"
+#include <cmath>
+
+// 用一批点重建索引
+void PointPyramid::build(const CityCoordinates &coords) {
+    count = coords.size();
+    xs = coords.x;
+    ys = coords.y;
+    ids.clear();
+    levels.clear();
+    if (count == 0) return;
+
+    double x0 = xs[0], x1 = xs[0];
+    double y0 = ys[0], y1 = ys[0];
+    for (int i = 0; i < count; ++i) {
+        x0 = qMin(x0, xs[i]);
+        x1 = qMax(x1, xs[i]);
+        y0 = qMin(y0, ys[i]);
+        y1 = qMax(y1, ys[i]);
+    }
+    double width = qMax(x1 - x0, 1e-9);
+    double height = qMax(y1 - y0, 1e-9);
+    minX = x0;
+    minY = y0;
+
+    // 第 0 层: 与 SpatialGrid 相同, 平均每格约 2 个点; 点几乎共线时改用长边来划分
+    Level base;
+    double cellCount = qMax(1.0, count / 2.0);
+    base.cellSize = std::sqrt(width * height / cellCount);
+    base.cellSize = qMax(base.cellSize, qMax(width, height) / cellCount);
+    base.cols = static_cast<int>(width / base.cellSize) + 1;
+    base.rows = static_cast<int>(height / base.cellSize) + 1;
+
+    // 计数排序: 先数每格的点数, 再转成起始位置, 最后按格子放入编号
+    std::vector<int> cellOf(count);
+    base.cells.assign(static_cast<size_t>(base.cols) * base.rows + 1, 0);
+    for (int i = 0; i < count; ++i) {
+        int cell = cellIndex(ys[i], minY, base.cellSize, base.rows) * base.cols
+                   + cellIndex(xs[i], minX, base.cellSize, base.cols);
+        cellOf[i] = cell;
+        base.cells[cell + 1]++;
+    }
+    for (size_t c = 1; c < base.cells.size(); ++c) {
+        base.cells[c] += base.cells[c - 1];
+    }
+    ids.resize(count);
+    std::vector<int> fill(base.cells.begin(), base.cells.end() - 1);
+    for (int i = 0; i < count; ++i) {
+        ids[fill[cellOf[i]]++] = i;
+    }
+    levels.push_back(std::move(base));
+
+    // 逐层合并 2x2 个格子, 每格保留上一层左下方第一个非空格子的代表点, 直到只剩一个格子
+    while (levels.back().cols > 1 || levels.back().rows > 1) {
+        const Level &fine = levels.back();
+        Level coarse;
+        coarse.cellSize = fine.cellSize * 2;
+        coarse.cols = (fine.cols + 1) / 2;
+        coarse.rows = (fine.rows + 1) / 2;
+        coarse.cells.assign(static_cast<size_t>(coarse.cols) * coarse.rows, -1);
+
+        bool fromBase = levels.size() == 1;
+        for (int gy = 0; gy < fine.rows; ++gy) {
+            for (int gx = 0; gx < fine.cols; ++gx) {
+                int cell = gy * fine.cols + gx;
+                int id;
+                if (fromBase) {
+                    id = fine.cells[cell] < fine.cells[cell + 1] ? ids[fine.cells[cell]] : -1;
+                } else {
+                    id = fine.cells[cell];
+                }
+                if (id < 0) continue;
+                int &slot = coarse.cells[(gy / 2) * coarse.cols + gx / 2];
+                if (slot < 0) slot = id;
+            }
+        }
+        levels.push_back(std::move(coarse));
+    }
+}
+
+// 选格子边长不超过 maxCellPixels 个像素的最粗一层, 放大到第 0 层格子也超过时用第 0 层(全部点)
+int PointPyramid::levelFor(double pixelsPerUnit, double maxCellPixels) const {
+    int level = 0;
+    for (int k = 1; k < levelCount(); ++k) {
+        if (levels[k].cellSize * pixelsPerUnit > maxCellPixels) break;
+        level = k;
+    }
+    return level;
+}
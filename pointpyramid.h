@@ -0,0 +1,89 @@
+#ifndef POINTPYRAMID_H
+#define POINTPYRAMID_H
+
+#include <QtGlobal>
+#include <cmath>
+#include <vector>
+#include "distancematrix.h"
+
+// 点集的多层网格索引, 用于按缩放级别抽稀和按视口裁剪
+// 第 0 层把平面划分成平均每格约 2 个点的格子, 按格子顺序保存全部点;
+// 第 k 层的格子边长是第 0 层的 2^k 倍, 每个非空格子只保留一个代表点.
+// 绘制时选格子不超过一个像素的最粗一层, 只遍历与视口相交的格子, 画出的点数与像素数同级, 与总点数无关
+class PointPyramid {
+public:
+    PointPyramid() {}
+
+    // 用一批点重建索引, 点的编号就是它在 coords 中的下标
+    void build(const CityCoordinates &coords);
+
+    int size() const { return count; }
+    int levelCount() const { return static_cast<int>(levels.size()); }
+
+    // 第 level 层的格子边长
+    double cellSize(int level) const { return levels[level].cellSize; }
+
+    // 每单位长度对应 pixelsPerUnit 个像素时, 选格子边长不超过 maxCellPixels 个像素的最粗一层
+    int levelFor(double pixelsPerUnit, double maxCellPixels = 1.0) const;
+
+    // 遍历第 level 层中落在矩形 [x0, x1] x [y0, y1] 内的点, func(id, x, y)
+    // 第 0 层是全部点, 其余层是每格一个的代表点
+    template <typename Func>
+    void forEachIn(int level, double x0, double y0, double x1, double y1, Func func) const;
+
+private:
+    struct Level {
+        double cellSize = 1;
+        int cols = 0, rows = 0;
+        std::vector<int> cells; // 第 0 层: 每格在 ids 中的起始位置(多一个结尾); 其余层: 每格的代表点, -1 为空
+    };
+
+    int count = 0;
+    double minX = 0, minY = 0; // 网格左下角, 各层相同
+    std::vector<double> xs, ys;
+    std::vector<int> ids;      // 第 0 层按格子顺序排列的点编号
+    std::vector<Level> levels;
+
+    // 先在 double 上截断到网格范围再转成 int, 缩得很小时视口换算出的坐标很大, 转换时不会溢出
+    static int cellIndex(double v, double origin, double size, int limit) {
+        return static_cast<int>(qBound(0.0, std::floor((v - origin) / size), limit - 1.0));
+    }
+};
+
+template <typename Func>
+void PointPyramid::forEachIn(int level, double x0, double y0, double x1, double y1, Func func) const {
+    if (count == 0 || level < 0 || level >= levelCount()) return;
+    const Level &grid = levels[level];
+    if (x1 < minX || y1 < minY
+        || x0 > minX + grid.cols * grid.cellSize || y0 > minY + grid.rows * grid.cellSize) return;
+
+    int gx0 = cellIndex(x0, minX, grid.cellSize, grid.cols);
+    int gx1 = cellIndex(x1, minX, grid.cellSize, grid.cols);
+    int gy0 = cellIndex(y0, minY, grid.cellSize, grid.rows);
+    int gy1 = cellIndex(y1, minY, grid.cellSize, grid.rows);
+
+    for (int gy = gy0; gy <= gy1; ++gy) {
+        // 只有边缘的格子需要逐点判断是否在矩形内
+        bool edgeY = gy == gy0 || gy == gy1;
+        for (int gx = gx0; gx <= gx1; ++gx) {
+            bool edge = edgeY || gx == gx0 || gx == gx1;
+            int cell = gy * grid.cols + gx;
+            if (level == 0) {
+                for (int k = grid.cells[cell]; k < grid.cells[cell + 1]; ++k) {
+                    int id = ids[k];
+                    double x = xs[id], y = ys[id];
+                    if (edge && (x < x0 || x > x1 || y < y0 || y > y1)) continue;
+                    func(id, x, y);
+                }
+            } else {
+                int id = grid.cells[cell];
+                if (id < 0) continue;
+                double x = xs[id], y = ys[id];
+                if (edge && (x < x0 || x > x1 || y < y0 || y > y1)) continue;
+                func(id, x, y);
+            }
+        }
+    }
+}
+
+#endif // POINTPYRAMID_H
@@ -0,0 +1,93 @@
+#ifndef SOLVERCONTROL_H
+#define SOLVERCONTROL_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "tourbuffer.h"
+
+// 求解器与界面之间的控制块: 取消标志、最新进度和最新回路
+// 求解线程在循环中检查取消标志(只是一次原子读), 并用 publish() 覆盖最新进度;
+// 界面线程按固定间隔用 takeProgress() 取走进度, 进度更新再频繁也不会淹没事件循环.
+// 回路快照走无锁的 TourBuffer, 求解线程每帧最多复制一次回路, 地图按自己的帧率取用.
+// 取消是协作式的: 求解器看到标志后尽快结束, 返回目前找到的最优回路
+class SolverControl {
+public:
+    // 一条进度
+    struct Progress {
+        double distance = 0;   // 目前最优回路长度
+        QString message;       // 进度描述
+        quint64 sequence = 0;  // 发布序号, 每次 publish() 加一
+    };
+
+    SolverControl() = default;
+    SolverControl(const SolverControl &) = delete;
+    SolverControl &operator=(const SolverControl &) = delete;
+
+    // 开始新的求解前清除取消标志和进度
+    void reset() {
+        cancelled.store(false, std::memory_order_relaxed);
+        tours.reset();
+        tourClock.invalidate();
+        std::lock_guard<std::mutex> lock(mutex);
+        latest = Progress();
+        taken = 0;
+    }
+
+    // 请求取消, 任意线程都可调用
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    // 交给求解引擎的取消标志
+    const std::atomic<bool> *cancelFlag() const { return &cancelled; }
+
+    // 求解线程发布进度, 只保留最新一条
+    void publish(double distance, const QString &message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        latest.distance = distance;
+        latest.message = message;
+        latest.sequence++;
+    }
+
+    // 取走上次调用以来的最新进度, 没有新进度时返回 false
+    bool takeProgress(Progress &out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (latest.sequence == taken) return false;
+        taken = latest.sequence;
+        out = latest;
+        return true;
+    }
+
+    // 回路快照的最小间隔(毫秒), 默认 33 即每秒 30 帧
+    void setTourInterval(qint64 ms) { tourIntervalMs = ms; }
+
+    // 求解线程: 距上次发布回路是否已满一帧; 返回 true 时应接着调用 publishTour()
+    // 回路快照只有一个写线程, 并行的求解器只在汇总结果的线程中调用
+    bool tourDue() {
+        if (tourClock.isValid() && tourClock.elapsed() < tourIntervalMs) return false;
+        tourClock.start();
+        return true;
+    }
+
+    // 求解线程发布当前最优回路(城市编号序列), 不加锁也不等待界面线程
+    template <typename Order>
+    void publishTour(const Order &order) { tours.publish(order.begin(), order.end()); }
+
+    // 界面线程取走最新回路, 没有新回路时返回 false
+    bool takeTour(std::vector<int> &order) { return tours.take(order); }
+
+private:
+    std::atomic<bool> cancelled{false};
+    std::mutex mutex;
+    Progress latest;
+    quint64 taken = 0; // 已取走的发布序号
+
+    TourBuffer tours;
+    QElapsedTimer tourClock; // 只由求解线程访问
+    qint64 tourIntervalMs = 33;
+};
+
+#endif // SOLVERCONTROL_H
@@ -0,0 +1,83 @@
+#include "solverservice.h"
+#include <new>
+
+SolverService::SolverService(CityManager *manager, QObject *parent)
+    : QObject(parent), manager(manager), timer(new QTimer(this)) {
+    timer->setInterval(100);
+    connect(timer, &QTimer::timeout, this, &SolverService::pollProgress);
+}
+
+SolverService::~SolverService() {
+    cancelAndWait();
+}
+
+bool SolverService::start(Job job) {
+    if (thread) return false;
+
+    control.reset();
+    manager->setSolverControl(&control);
+    result = Result();
+    logBuffer.clear();
+    clock.start();
+
+    thread = QThread::create([this, job]() {
+        // 距离矩阵等大块内存分配失败时只让这次求解失败, 不让整个程序退出
+        try {
+            job(result);
+        } catch (const std::bad_alloc &) {
+            result.path.clear();
+            result.failure = "内存不足, 城市数对这个算法来说太多了";
+        }
+    });
+    connect(thread, &QThread::finished, this, &SolverService::onThreadFinished);
+    thread->start();
+    timer->start();
+    return true;
+}
+
+void SolverService::cancel() {
+    control.cancel();
+}
+
+void SolverService::cancelAndWait() {
+    if (!thread) return;
+    control.cancel();
+    thread->wait();
+    disconnect(thread, nullptr, this, nullptr);
+    delete thread;
+    thread = nullptr;
+    timer->stop();
+    manager->setSolverControl(nullptr);
+}
+
+// 只取最新一条进度, 求解器发布得再快, 界面也只按定时器的频率刷新
+void SolverService::pollProgress() {
+    SolverControl::Progress latest;
+    if (control.takeProgress(latest)) {
+        emit progress(latest.distance, latest.message, clock.elapsed());
+    }
+
+    qint64 dropped = 0;
+    QList<QString> taken = logBuffer.take(&dropped);
+    if (taken.isEmpty() && dropped == 0) return;
+    QStringList lines;
+    if (dropped > 0) lines << QString("... 省略 %1 行日志 ...").arg(dropped);
+    lines << taken;
+    emit logLines(lines);
+}
+
+void SolverService::onThreadFinished() {
+    timer->stop();
+    pollProgress();
+
+    thread->deleteLater();
+    thread = nullptr;
+    manager->setSolverControl(nullptr);
+
+    // 先移出结果, 接收方可以在 finished 中立即开始下一次求解
+    Result done = std::move(result);
+    result = Result();
+    done.cancelled = control.isCancelled();
+    done.elapsedMs = clock.elapsed();
+    emit finished(done);
+}
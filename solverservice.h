@@ -0,0 +1,75 @@
+#ifndef SOLVERSERVICE_H
+#define SOLVERSERVICE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <functional>
+#include "citymanager.h"
+#include "solvercontrol.h"
+#include "stepsink.h"
+
+// 后台求解服务
+// 在单独的线程中运行求解任务, 界面线程只负责显示: 定时器按固定间隔从控制块取最新进度并发出 progress 信号,
+// 同时取走这段时间的日志发出 logLines 信号, 求解结束后在界面线程发出 finished 信号. 同一时间只运行一个任务, 运行期间 CityManager 的城市不能修改
+class SolverService : public QObject {
+    Q_OBJECT
+public:
+    // 求解结果, 由任务在后台线程中填写
+    struct Result {
+        QList<City> path;        // 求解得到的路径, 失败时为空
+        QString summary;         // 非空时弹窗显示
+        QString failure;         // 路径为空时的原因
+        bool cancelled = false;  // 是否被取消
+        qint64 elapsedMs = 0;    // 用时
+    };
+
+    // 求解任务, 在后台线程中执行
+    using Job = std::function<void(Result &result)>;
+
+    // manager 需在服务使用期间保持有效
+    explicit SolverService(CityManager *manager, QObject *parent = nullptr);
+    ~SolverService() override;
+
+    bool isRunning() const { return thread != nullptr; }
+
+    // 开始求解, 已有任务在运行时返回 false
+    bool start(Job job);
+
+    // 请求取消, 求解器尽快返回目前找到的最优路径
+    void cancel();
+
+    // 取消并等待后台线程结束, 不再发出 finished 信号(关闭窗口时使用)
+    void cancelAndWait();
+
+    // 进度信号的最小间隔(毫秒), 默认 100
+    void setProgressInterval(int ms) { timer->setInterval(qMax(10, ms)); }
+
+    // 求解器与界面共用的控制块, 地图从中取实时回路
+    SolverControl *solverControl() { return &control; }
+
+    // 求解线程追加一行日志; 日志放在有上限的环形缓冲区中, 界面来不及取走时丢弃最旧的行
+    void appendLog(const QString &line) { logBuffer.append(line); }
+
+signals:
+    void progress(double distance, const QString &message, qint64 elapsedMs);
+    void logLines(const QStringList &lines);
+    void finished(const SolverService::Result &result);
+
+private slots:
+    void pollProgress();
+    void onThreadFinished();
+
+private:
+    CityManager *manager;
+    SolverControl control;
+    QThread *thread = nullptr;
+    QTimer *timer;
+    QElapsedTimer clock;
+    RingBufferSink<QString> logBuffer{5000};
+    Result result; // 只在后台线程运行期间由任务访问
+};
+
+#endif // SOLVERSERVICE_H
@@ -0,0 +1,157 @@
+#include "spatialgrid.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+SpatialGrid::SpatialGrid() {
+}
+
+// 用一批点重建索引
+void SpatialGrid::build(const QList<Entry> &points) {
+    if (points.isEmpty()) {
+        cells.clear();
+        cols = rows = 0;
+        count = 0;
+        return;
+    }
+
+    double x0 = points[0].x, x1 = points[0].x;
+    double y0 = points[0].y, y1 = points[0].y;
+    for (const Entry &entry : points) {
+        x0 = qMin(x0, entry.x);
+        x1 = qMax(x1, entry.x);
+        y0 = qMin(y0, entry.y);
+        y1 = qMax(y1, entry.y);
+    }
+    rebuild(x0, y0, x1, y1, points);
+}
+
+// 按给定边界重建网格
+void SpatialGrid::rebuild(double x0, double y0, double x1, double y1, const QList<Entry> &points) {
+    double width = qMax(x1 - x0, 1e-9);
+    double height = qMax(y1 - y0, 1e-9);
+
+    // 平均每格约 2 个点, 格子数至少为 1
+    double cellCount = qMax(1.0, points.size() / 2.0);
+    cellSize = std::sqrt(width * height / cellCount);
+    // 点几乎共线时面积接近 0, 改用长边来划分
+    cellSize = qMax(cellSize, qMax(width, height) / cellCount);
+
+    // 右上边界稍微外扩, 保证最大坐标也严格落在网格内
+    cols = static_cast<int>(width / cellSize) + 1;
+    rows = static_cast<int>(height / cellSize) + 1;
+    minX = x0;
+    minY = y0;
+
+    cells = QList<QList<Entry>>(cols * rows);
+    count = 0;
+    for (const Entry &entry : points) {
+        cells[cellY(entry.y) * cols + cellX(entry.x)].append(entry);
+        count++;
+    }
+}
+
+// 取出全部点
+QList<SpatialGrid::Entry> SpatialGrid::entries() const {
+    QList<Entry> result;
+    result.reserve(count);
+    for (const QList<Entry> &cell : cells) {
+        result.append(cell);
+    }
+    return result;
+}
+
+// 插入一个点
+void SpatialGrid::insert(int id, double x, double y) {
+    if (contains(x, y) && count < 4 * cols * rows) {
+        cells[cellY(y) * cols + cellX(x)].append({x, y, id});
+        count++;
+        return;
+    }
+
+    // 点落在边界外: 把边界朝该方向扩大一倍再重建, 逐个追加时重建次数只有对数级
+    QList<Entry> points = entries();
+    points.append({x, y, id});
+    if (cols == 0 || count >= 4 * cols * rows) {
+        // 第一个点, 或点数远超格子数: 按实际范围重新划分
+        build(points);
+        return;
+    }
+
+    double x0 = minX, y0 = minY;
+    double x1 = minX + cols * cellSize, y1 = minY + rows * cellSize;
+    double width = x1 - x0, height = y1 - y0;
+    if (x < x0) x0 = qMin(x, x0 - width);
+    if (x >= x1) x1 = qMax(x, x1 + width);
+    if (y < y0) y0 = qMin(y, y0 - height);
+    if (y >= y1) y1 = qMax(y, y1 + height);
+    rebuild(x0, y0, x1, y1, points);
+}
+
+// 删除一个点
+bool SpatialGrid::remove(int id, double x, double y) {
+    if (!contains(x, y)) return false;
+
+    QList<Entry> &cell = cells[cellY(y) * cols + cellX(x)];
+    for (int i = 0; i < cell.size(); ++i) {
+        if (cell[i].id == id) {
+            // 与最后一个元素交换后删除, 避免移动
+            cell[i] = cell.last();
+            cell.removeLast();
+            count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 清空所有点
+void SpatialGrid::clear() {
+    for (QList<Entry> &cell : cells) {
+        cell.clear();
+    }
+    count = 0;
+}
+
+// 范围查询
+QList<int> SpatialGrid::queryRange(double cx, double cy, double range) const {
+    QList<int> result;
+    forEachWithin(cx, cy, range, [&result](const Entry &entry) {
+        result.append(entry.id);
+    });
+    return result;
+}
+
+// k 近邻查询
+// 平均每格约 2 个点, 先用大约能覆盖 k 个点的半径查询, 点数不够时半径加倍
+QList<int> SpatialGrid::nearest(double cx, double cy, int k) const {
+    QList<int> result;
+    if (count == 0 || k <= 0) return result;
+    k = qMin(k, count);
+
+    // 覆盖整个网格所需的半径, 到这个半径一定能找到全部点
+    double dx = qMax(std::fabs(cx - minX), std::fabs(cx - (minX + cols * cellSize)));
+    double dy = qMax(std::fabs(cy - minY), std::fabs(cy - (minY + rows * cellSize)));
+    double maxRange = std::sqrt(dx * dx + dy * dy);
+
+    std::vector<std::pair<double, int>> found;
+    double range = cellSize * std::sqrt(k / 2.0 + 1);
+    while (true) {
+        found.clear();
+        forEachWithin(cx, cy, range, [&](const Entry &entry) {
+            double ex = entry.x - cx;
+            double ey = entry.y - cy;
+            found.emplace_back(ex * ex + ey * ey, entry.id);
+        });
+        if (static_cast<int>(found.size()) >= k || range >= maxRange) break;
+        range = qMin(range * 2, maxRange);
+    }
+
+    k = qMin(k, static_cast<int>(found.size()));
+    std::partial_sort(found.begin(), found.begin() + k, found.end());
+    result.reserve(k);
+    for (int i = 0; i < k; ++i) {
+        result.append(found[i].second);
+    }
+    return result;
+}
@@ -0,0 +1,125 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <QList>
+#include <cmath>
+
+// 均匀网格空间索引
+// 平面按边长 cellSize 划分成 cols * rows 个格子, 每个格子保存落在其中的点;
+// 范围查询只访问与查询圆相交的格子, 用平方距离比较, 不开方
+class SpatialGrid {
+public:
+    struct Entry {
+        double x;
+        double y;
+        int id;
+    };
+
+    SpatialGrid();
+
+    // 用一批点重建索引, 按点数自动选择格子大小(平均每格约 2 个点)
+    void build(const QList<Entry> &points);
+
+    // 插入一个点, 超出当前边界或点数过多时按倍增策略重建
+    void insert(int id, double x, double y);
+
+    // 删除一个点, (x, y) 必须是插入时的坐标
+    bool remove(int id, double x, double y);
+
+    // 清空所有点, 保留格子数组
+    void clear();
+
+    int size() const { return count; }
+
+    // 遍历与 (cx, cy) 距离不超过 range 的所有点
+    template <typename Func>
+    void forEachWithin(double cx, double cy, double range, Func func) const;
+
+    // 返回与 (cx, cy) 距离不超过 range 的所有点的编号
+    QList<int> queryRange(double cx, double cy, double range) const;
+
+    // 返回离 (cx, cy) 最近的至多 k 个点的编号, 按距离从近到远
+    QList<int> nearest(double cx, double cy, int k) const;
+
+private:
+    double minX = 0, minY = 0; // 网格左下角
+    double cellSize = 1;       // 格子边长
+    int cols = 0, rows = 0;    // 格子列数, 行数
+    int count = 0;             // 点数
+    QList<QList<Entry>> cells; // 按行优先存放的格子
+
+    // 先在 double 上截断到网格范围再转成 int, 远离网格或无穷大的坐标转换时不会溢出
+    int cellX(double x) const {
+        return static_cast<int>(qBound(0.0, std::floor((x - minX) / cellSize), cols - 1.0));
+    }
+    int cellY(double y) const {
+        return static_cast<int>(qBound(0.0, std::floor((y - minY) / cellSize), rows - 1.0));
+    }
+    bool contains(double x, double y) const {
+        return cols > 0 && x >= minX && y >= minY
+               && x < minX + cols * cellSize && y < minY + rows * cellSize;
+    }
+
+    // 按给定边界重建网格
+    void rebuild(double x0, double y0, double x1, double y1, const QList<Entry> &points);
+
+    // 取出全部点
+    QList<Entry> entries() const;
+};
+
+template <typename Func>
+void SpatialGrid::forEachWithin(double cx, double cy, double range, Func func) const {
+    if (count == 0 || !(range >= 0)) return; // 负数和 NaN 查不到任何点
+
+    double range2 = range * range;
+
+    // 查询圆覆盖整个网格(包括无穷大的 range)时不必逐格判断, 直接遍历全部点
+    double farGridX = qMax(std::fabs(cx - minX), std::fabs(cx - (minX + cols * cellSize)));
+    double farGridY = qMax(std::fabs(cy - minY), std::fabs(cy - (minY + rows * cellSize)));
+    if (farGridX * farGridX + farGridY * farGridY <= range2) {
+        for (const QList<Entry> &cell : cells) {
+            for (const Entry &entry : cell) {
+                func(entry);
+            }
+        }
+        return;
+    }
+
+    int x0 = cellX(cx - range), x1 = cellX(cx + range);
+    int y0 = cellY(cy - range), y1 = cellY(cy + range);
+
+    for (int gy = y0; gy <= y1; ++gy) {
+        double cellMinY = minY + gy * cellSize;
+        double cellMaxY = cellMinY + cellSize;
+        // 查询中心到格子在 y 方向上的最近、最远距离
+        double nearY = cy < cellMinY ? cellMinY - cy : (cy > cellMaxY ? cy - cellMaxY : 0);
+        double farY = qMax(std::fabs(cy - cellMinY), std::fabs(cy - cellMaxY));
+
+        for (int gx = x0; gx <= x1; ++gx) {
+            const QList<Entry> &cell = cells[gy * cols + gx];
+            if (cell.isEmpty()) continue;
+
+            double cellMinX = minX + gx * cellSize;
+            double cellMaxX = cellMinX + cellSize;
+            double nearX = cx < cellMinX ? cellMinX - cx : (cx > cellMaxX ? cx - cellMaxX : 0);
+            if (nearX * nearX + nearY * nearY > range2) continue; // 整个格子都在圆外
+
+            double farX = qMax(std::fabs(cx - cellMinX), std::fabs(cx - cellMaxX));
+            bool inside = farX * farX + farY * farY <= range2; // 整个格子都在圆内
+
+            for (const Entry &entry : cell) {
+                if (inside) {
+                    func(entry);
+                    continue;
+                }
+                double dx = entry.x - cx;
+                double dy = entry.y - cy;
+                if (dx * dx + dy * dy <= range2) {
+                    func(entry);
+                }
+            }
+        }
+    }
+}
+
+#endif // SPATIALGRID_H
@@ -0,0 +1,136 @@
+#ifndef STEPSINK_H
+#define STEPSINK_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QtGlobal>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// 求解步骤的接收端
+// 求解器把步骤分成两类:
+//   常规步骤(迭代采样、找到更优解、周期统计): 用 add(make) 记录, 接收端不要这一步时 make 不会被调用,
+//     步骤和消息字符串都不会构造; setMinInterval() 可以限制常规步骤的频率
+//   关键步骤(开始、结束、失败原因): 用 append(step) 记录, 总是交给接收端
+// 不需要日志时求解器收到空指针, 每个记录点只多一次指针判断
+template <typename Step>
+class StepSink {
+public:
+    StepSink() { clock.start(); }
+    virtual ~StepSink() = default;
+
+    // 记录常规步骤, make() 返回构造好的步骤
+    template <typename Make>
+    void add(Make &&make) {
+        if (accept()) push(make());
+    }
+
+    // 记录关键步骤
+    void append(Step step) { push(std::move(step)); }
+
+    // 常规步骤的最小间隔(毫秒), 间隔内的常规步骤直接丢弃; 0 表示全部接收
+    void setMinInterval(qint64 ms) { minIntervalMs = ms; }
+
+protected:
+    virtual void push(Step &&step) = 0;
+
+private:
+    QElapsedTimer clock;
+    qint64 minIntervalMs = 0;
+    qint64 lastAccepted = -1;
+
+    bool accept() {
+        if (minIntervalMs <= 0) return true;
+        qint64 now = clock.elapsed();
+        if (lastAccepted >= 0 && now - lastAccepted < minIntervalMs) return false;
+        lastAccepted = now;
+        return true;
+    }
+};
+
+// 环形缓冲区: 只保留最近 capacity 个步骤, 内存有上限
+// 写入和取出都加锁, 可以由求解线程写入、界面线程用 take() 边求解边取走
+template <typename Step>
+class RingBufferSink : public StepSink<Step> {
+public:
+    explicit RingBufferSink(int capacity = 1000) : capacity(qMax(1, capacity)) {}
+
+    // 按记录顺序返回缓冲区中的步骤, 不取走
+    QList<Step> steps() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        QList<Step> result;
+        result.reserve(count);
+        for (int i = 0; i < count; ++i) result.append(buffer[(head + i) % capacity]);
+        return result;
+    }
+
+    // 取走缓冲区中的全部步骤; dropped 非空时返回上次取走以来被覆盖的步骤数
+    QList<Step> take(qint64 *dropped = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        QList<Step> result;
+        result.reserve(count);
+        for (int i = 0; i < count; ++i) result.append(std::move(buffer[(head + i) % capacity]));
+        head = 0;
+        count = 0;
+        if (dropped) *dropped = overwritten;
+        overwritten = 0;
+        return result;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        head = 0;
+        count = 0;
+        overwritten = 0;
+        recorded = 0;
+    }
+
+    // 记录过的步骤总数(包括被覆盖的)
+    qint64 total() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return recorded;
+    }
+
+protected:
+    void push(Step &&step) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (buffer.empty()) buffer.resize(capacity);
+        recorded++;
+        if (count < capacity) {
+            buffer[(head + count) % capacity] = std::move(step);
+            count++;
+        } else {
+            // 已满, 覆盖最旧的一步
+            buffer[head] = std::move(step);
+            head = (head + 1) % capacity;
+            overwritten++;
+        }
+    }
+
+private:
+    int capacity;
+    std::vector<Step> buffer;
+    int head = 0;  // 最旧一步的位置
+    int count = 0;
+    qint64 overwritten = 0; // 上次取走以来被覆盖的步骤数
+    qint64 recorded = 0;
+    mutable std::mutex mutex;
+};
+
+// 回调: 每个步骤交给回调函数处理(例如格式化后转发给界面), 自身不保存
+// 回调在求解线程中执行
+template <typename Step>
+class CallbackSink : public StepSink<Step> {
+public:
+    explicit CallbackSink(std::function<void(const Step &)> callback) : callback(std::move(callback)) {}
+
+protected:
+    void push(Step &&step) override { callback(step); }
+
+private:
+    std::function<void(const Step &)> callback;
+};
+
+#endif // STEPSINK_H
@@ -0,0 +1,113 @@
+#include "threadpool.h"
+#include <QThread>
+
+WorkStealingPool::WorkStealingPool(int threadCount) {
+    if (threadCount <= 0) threadCount = idealThreadCount();
+
+    // 线程启动前先准备好所有队列, 工作线程一启动就可能去别的队列窃取任务
+    workerCount = threadCount;
+    workers.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        queues.push_back(new Queue);
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    for (Queue *queue : queues) {
+        delete queue;
+    }
+}
+
+int WorkStealingPool::idealThreadCount() {
+    return qMax(1, QThread::idealThreadCount());
+}
+
+// 提交任务
+void WorkStealingPool::submit(Task task) {
+    int index = nextQueue.fetch_add(1, std::memory_order_relaxed) % threadCount();
+    pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    {
+        // 在 stateMutex 下通知, 避免工作线程在检查队列和进入等待之间错过唤醒
+        std::lock_guard<std::mutex> lock(stateMutex);
+    }
+    workAvailable.notify_all();
+}
+
+// 等待所有任务完成
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this] { return pending.load() == 0; });
+}
+
+// 并行执行 count 个任务
+void WorkStealingPool::run(int count, const std::function<void(int index, int worker)> &func) {
+    for (int i = 0; i < count; ++i) {
+        submit([&func, i](int worker) { func(i, worker); });
+    }
+    wait();
+}
+
+// 先从自己队列的尾部取任务, 没有再从其他队列的头部窃取
+bool WorkStealingPool::takeTask(int index, Task &task) {
+    {
+        Queue *own = queues[index];
+        std::lock_guard<std::mutex> lock(own->mutex);
+        if (!own->tasks.empty()) {
+            task = std::move(own->tasks.back());
+            own->tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    int count = threadCount();
+    for (int offset = 1; offset < count; ++offset) {
+        Queue *victim = queues[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->tasks.empty()) {
+            task = std::move(victim->tasks.front());
+            victim->tasks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 工作线程主循环
+void WorkStealingPool::workerLoop(int index) {
+    while (true) {
+        Task task;
+        if (takeTask(index, task)) {
+            task(index);
+            if (pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        // 所有队列都为空时休眠, 直到有新任务提交
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workAvailable.wait(lock, [this] {
+            return stopping || queued.load() > 0;
+        });
+        if (stopping) return;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <QList>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池
+// 每个工作线程有自己的任务队列, 从队尾取自己的任务, 自己的队列空了就从别的线程队首"偷"任务,
+// 任务粒度不均匀时(例如穷举时某些前缀被剪枝)也能让所有核心保持忙碌
+class WorkStealingPool {
+public:
+    // 任务参数为执行该任务的工作线程编号, 可用于访问每个线程独立的缓冲区
+    using Task = std::function<void(int worker)>;
+
+    // threadCount <= 0 时使用 CPU 核心数
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    int threadCount() const { return workerCount; }
+
+    // 提交任务, 按轮转方式分配到各线程的队列
+    void submit(Task task);
+
+    // 阻塞直到所有已提交的任务执行完毕
+    void wait();
+
+    // 执行 func(0) ... func(count-1) 并等待全部完成
+    void run(int count, const std::function<void(int index, int worker)> &func);
+
+    // 默认线程数
+    static int idealThreadCount();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    int workerCount = 0;
+    std::vector<std::thread> workers;
+    std::vector<Queue *> queues;
+
+    std::mutex stateMutex;
+    std::condition_variable workAvailable; // 有新任务或要求退出
+    std::condition_variable allDone;       // 所有任务完成
+    std::atomic<int> pending{0};           // 未完成的任务数
+    std::atomic<int> queued{0};            // 还在队列中等待执行的任务数
+    std::atomic<int> nextQueue{0};
+    bool stopping = false;
+
+    void workerLoop(int index);
+    bool takeTask(int index, Task &task);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,49 @@
+#ifndef TOURBUFFER_H
+#define TOURBUFFER_H
+
+#include <atomic>
+#include <vector>
+
+// 回路快照的无锁缓冲区, 一个写线程(求解器)、一个读线程(界面)
+// 三个槽轮换: 写线程独占一个槽写入, 写完把它和"中间槽"原子交换; 读线程有新快照时把自己的槽和中间槽交换.
+// 双方都只做一次原子交换, 谁也不等谁, 界面读得再慢也不会拖慢求解器; 读线程总是拿到最新写完的快照
+class TourBuffer {
+public:
+    TourBuffer() = default;
+    TourBuffer(const TourBuffer &) = delete;
+    TourBuffer &operator=(const TourBuffer &) = delete;
+
+    // 丢弃未读的快照, 只能在没有读写时调用
+    void reset() {
+        writeSlot = 0;
+        middle.store(1, std::memory_order_relaxed);
+        readSlot = 2;
+    }
+
+    // 写线程: 发布一条回路(城市编号序列); 槽中的数组会被复用, 稳定后不再分配内存
+    template <typename Iterator>
+    void publish(Iterator first, Iterator last) {
+        buffers[writeSlot].assign(first, last);
+        writeSlot = middle.exchange(writeSlot | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // 读线程: 取走最新快照, 没有新快照时返回 false
+    // 与 order 交换而不是复制, order 原有的数组留给写线程复用
+    bool take(std::vector<int> &order) {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        readSlot = middle.exchange(readSlot, std::memory_order_acq_rel) & INDEX;
+        order.swap(buffers[readSlot]);
+        return true;
+    }
+
+private:
+    static const int INDEX = 3;
+    static const int FRESH = 4; // 中间槽里是读线程还没取走的快照
+
+    std::vector<int> buffers[3];
+    int writeSlot = 0;            // 只由写线程访问
+    std::atomic<int> middle{1};
+    int readSlot = 2;             // 只由读线程访问
+};
+
+#endif // TOURBUFFER_H
@@ -0,0 +1,319 @@
+#include "tourconstruction.h"
+#include "disjointset.h"
+#include "spatialgrid.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace {
+
+// 点在 2^order * 2^order 网格上的 Hilbert 曲线序号
+quint64 hilbertIndex(quint32 x, quint32 y, int order) {
+    const quint32 side = 1u << order;
+    quint64 index = 0;
+    for (quint32 s = side >> 1; s > 0; s >>= 1) {
+        quint32 rx = (x & s) ? 1 : 0;
+        quint32 ry = (y & s) ? 1 : 0;
+        index += static_cast<quint64>(s) * s * ((3 * rx) ^ ry);
+        // 旋转象限, 使子曲线的方向与整体一致
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+} // namespace
+
+TourConstruction::TourConstruction(const CityCoordinates &coords, int neighborCount)
+    : coords(coords), n(coords.size()), k(qMax(0, qMin(neighborCount, coords.size() - 1))) {
+    QList<SpatialGrid::Entry> entries;
+    entries.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        entries.append({coords.x[i], coords.y[i], i});
+    }
+    SpatialGrid grid;
+    grid.build(entries);
+
+    // 多取一个近邻再去掉城市自身
+    neighborList.assign(static_cast<size_t>(n) * k, 0);
+    for (int i = 0; i < n; ++i) {
+        QList<int> nearest = grid.nearest(coords.x[i], coords.y[i], k + 1);
+        int count = 0;
+        for (int j : nearest) {
+            if (j == i || count == k) continue;
+            neighborList[static_cast<size_t>(i) * k + count] = j;
+            count++;
+        }
+    }
+}
+
+QString TourConstruction::methodName(Method method) {
+    switch (method) {
+    case NearestNeighbor: return "最近邻";
+    case GreedyEdge: return "贪心边";
+    case SpaceFillingCurve: return "空间填充曲线";
+    case ConvexHullInsertion: return "凸包最廉价插入";
+    }
+    return QString();
+}
+
+std::vector<int> TourConstruction::build(Method method, int start) const {
+    switch (method) {
+    case NearestNeighbor: return nearestNeighbor(start);
+    case GreedyEdge: return greedyEdge();
+    case SpaceFillingCurve: return spaceFillingCurve();
+    case ConvexHullInsertion: return convexHullInsertion();
+    }
+    return nearestNeighbor(start);
+}
+
+// 最近邻: 未访问城市放在空间网格中, 访问后删除, 每一步只查询当前城市附近的格子
+std::vector<int> TourConstruction::nearestNeighbor(int start) const {
+    std::vector<int> result;
+    if (n == 0) return result;
+    result.reserve(n);
+
+    QList<SpatialGrid::Entry> entries;
+    entries.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        entries.append({coords.x[i], coords.y[i], i});
+    }
+    SpatialGrid unvisited;
+    unvisited.build(entries);
+
+    int current = qBound(0, start, n - 1);
+    while (true) {
+        unvisited.remove(current, coords.x[current], coords.y[current]);
+        result.push_back(current);
+        if (static_cast<int>(result.size()) == n) break;
+        current = unvisited.nearest(coords.x[current], coords.y[current], 1).first();
+    }
+    return result;
+}
+
+// 贪心边: k 近邻边按长度排序, 依次加入两端度数都小于 2 且不会形成回路的边;
+// 剩下的片段从一端走到另一端, 再用空间网格找最近的片段端点接上
+std::vector<int> TourConstruction::greedyEdge() const {
+    std::vector<int> result;
+    if (n <= 3) {
+        for (int i = 0; i < n; ++i) result.push_back(i);
+        return result;
+    }
+
+    struct Edge {
+        double length;
+        int a, b;
+        bool operator<(const Edge &other) const {
+            if (length != other.length) return length < other.length;
+            if (a != other.a) return a < other.a;
+            return b < other.b;
+        }
+    };
+    std::vector<Edge> edges;
+    edges.reserve(static_cast<size_t>(n) * k);
+    for (int i = 0; i < n; ++i) {
+        const int *candidates = neighbors(i);
+        for (int t = 0; t < k; ++t) {
+            int j = candidates[t];
+            edges.push_back({dist(i, j), qMin(i, j), qMax(i, j)});
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<int> adjacent(2 * n, -1); // 每个城市至多两条边
+    std::vector<int> degree(n, 0);
+    DisjointSet fragments(n);
+    for (size_t e = 0; e < edges.size(); ++e) {
+        const Edge &edge = edges[e];
+        if (e > 0 && edge.a == edges[e - 1].a && edge.b == edges[e - 1].b) continue; // 两端互为近邻时出现两次
+        if (degree[edge.a] == 2 || degree[edge.b] == 2) continue;
+        if (!fragments.unite(edge.a, edge.b)) continue;
+        adjacent[2 * edge.a + degree[edge.a]++] = edge.b;
+        adjacent[2 * edge.b + degree[edge.b]++] = edge.a;
+    }
+
+    // 片段端点(度数小于 2 的城市)放进空间网格
+    QList<SpatialGrid::Entry> ends;
+    for (int i = 0; i < n; ++i) {
+        if (degree[i] < 2) ends.append({coords.x[i], coords.y[i], i});
+    }
+    SpatialGrid endGrid;
+    endGrid.build(ends);
+
+    result.reserve(n);
+    int entry = ends.first().id;
+    while (true) {
+        endGrid.remove(entry, coords.x[entry], coords.y[entry]);
+        int previous = -1;
+        int current = entry;
+        while (true) {
+            result.push_back(current);
+            int next = adjacent[2 * current] != previous ? adjacent[2 * current] : adjacent[2 * current + 1];
+            if (next < 0 || (degree[current] == 1 && current != entry)) break;
+            previous = current;
+            current = next;
+        }
+        if (current != entry) endGrid.remove(current, coords.x[current], coords.y[current]);
+        if (endGrid.size() == 0) break;
+        entry = endGrid.nearest(coords.x[current], coords.y[current], 1).first();
+    }
+    return result;
+}
+
+// 空间填充曲线: 坐标缩放到 2^16 * 2^16 的网格, 按 Hilbert 序号排序, 相邻的序号在平面上也相邻
+std::vector<int> TourConstruction::spaceFillingCurve() const {
+    std::vector<int> result(n);
+    std::iota(result.begin(), result.end(), 0);
+    if (n <= 3) return result;
+
+    const int order = 16;
+    double x0 = *std::min_element(coords.x.begin(), coords.x.end());
+    double y0 = *std::min_element(coords.y.begin(), coords.y.end());
+    double x1 = *std::max_element(coords.x.begin(), coords.x.end());
+    double y1 = *std::max_element(coords.y.begin(), coords.y.end());
+    double scale = ((1u << order) - 1) / qMax(qMax(x1 - x0, y1 - y0), 1e-9);
+
+    std::vector<quint64> keys(n);
+    for (int i = 0; i < n; ++i) {
+        quint32 gx = static_cast<quint32>((coords.x[i] - x0) * scale);
+        quint32 gy = static_cast<quint32>((coords.y[i] - y0) * scale);
+        keys[i] = hilbertIndex(gx, gy, order);
+    }
+    std::sort(result.begin(), result.end(), [&](int a, int b) {
+        return keys[a] != keys[b] ? keys[a] < keys[b] : a < b;
+    });
+    return result;
+}
+
+// Andrew 单调链, 共线的点不算顶点
+std::vector<int> TourConstruction::convexHull() const {
+    std::vector<int> sorted(n);
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::sort(sorted.begin(), sorted.end(), [&](int a, int b) {
+        if (coords.x[a] != coords.x[b]) return coords.x[a] < coords.x[b];
+        if (coords.y[a] != coords.y[b]) return coords.y[a] < coords.y[b];
+        return a < b;
+    });
+    auto cross = [&](int o, int a, int b) {
+        return (coords.x[a] - coords.x[o]) * (coords.y[b] - coords.y[o])
+               - (coords.y[a] - coords.y[o]) * (coords.x[b] - coords.x[o]);
+    };
+
+    std::vector<int> hull(2 * n);
+    int size = 0;
+    for (int i = 0; i < n; ++i) {
+        while (size >= 2 && cross(hull[size - 2], hull[size - 1], sorted[i]) <= 0) size--;
+        hull[size++] = sorted[i];
+    }
+    for (int i = n - 2, lower = size + 1; i >= 0; --i) {
+        while (size >= lower && cross(hull[size - 2], hull[size - 1], sorted[i]) <= 0) size--;
+        hull[size++] = sorted[i];
+    }
+    hull.resize(qMax(1, size - 1)); // 最后一个点与第一个点相同
+    return hull;
+}
+
+// 凸包最廉价插入: 回路从凸包开始, 每个未插入城市只考虑与它的 k 近邻(已在回路中)相连的边,
+// 都不在回路中时改用回路中离它最近的城市; 代价放进最小堆, 弹出时重新计算, 变大了就放回去(惰性更新)
+std::vector<int> TourConstruction::convexHullInsertion() const {
+    std::vector<int> result;
+    if (n <= 3) {
+        for (int i = 0; i < n; ++i) result.push_back(i);
+        return result;
+    }
+
+    std::vector<int> next(n, -1), prev(n, -1);
+    std::vector<char> inTour(n, 0);
+    std::vector<int> hull = convexHull();
+    QList<SpatialGrid::Entry> tourEntries;
+    for (int i = 0; i < static_cast<int>(hull.size()); ++i) {
+        int city = hull[i];
+        next[city] = hull[(i + 1) % hull.size()];
+        prev[next[city]] = city;
+        inTour[city] = 1;
+        tourEntries.append({coords.x[city], coords.y[city], city});
+    }
+    SpatialGrid tourGrid;
+    tourGrid.build(tourEntries);
+
+    // 反向近邻表: 把 c 列为近邻的城市, c 插入后它们可能有更便宜的插入位置
+    std::vector<int> reverseStart(n + 1, 0), reverseList(static_cast<size_t>(n) * k);
+    for (int i = 0; i < n; ++i) {
+        for (int t = 0; t < k; ++t) reverseStart[neighbors(i)[t] + 1]++;
+    }
+    std::partial_sum(reverseStart.begin(), reverseStart.end(), reverseStart.begin());
+    std::vector<int> fill(reverseStart.begin(), reverseStart.end() - 1);
+    for (int i = 0; i < n; ++i) {
+        for (int t = 0; t < k; ++t) reverseList[fill[neighbors(i)[t]]++] = i;
+    }
+
+    // 插入 city 的最小代价, after 返回插入位置的前一个城市
+    auto insertionCost = [&](int city, int &after) {
+        double best = std::numeric_limits<double>::max();
+        auto tryAnchor = [&](int anchor) {
+            for (int u : {prev[anchor], anchor}) {
+                int v = next[u];
+                double cost = dist(u, city) + dist(city, v) - dist(u, v);
+                if (cost < best) {
+                    best = cost;
+                    after = u;
+                }
+            }
+        };
+        const int *candidates = neighbors(city);
+        for (int t = 0; t < k; ++t) {
+            if (inTour[candidates[t]]) tryAnchor(candidates[t]);
+        }
+        if (best == std::numeric_limits<double>::max()) {
+            tryAnchor(tourGrid.nearest(coords.x[city], coords.y[city], 1).first());
+        }
+        return best;
+    };
+
+    using Item = std::pair<double, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+    int after = 0;
+    for (int city = 0; city < n; ++city) {
+        if (!inTour[city]) heap.push({insertionCost(city, after), city});
+    }
+
+    while (!heap.empty()) {
+        Item item = heap.top();
+        heap.pop();
+        int city = item.second;
+        if (inTour[city]) continue;
+        double cost = insertionCost(city, after);
+        if (cost > item.first) {
+            heap.push({cost, city});
+            continue;
+        }
+
+        int before = next[after];
+        next[after] = city;
+        prev[city] = after;
+        next[city] = before;
+        prev[before] = city;
+        inTour[city] = 1;
+        tourGrid.insert(city, coords.x[city], coords.y[city]);
+
+        for (int r = reverseStart[city]; r < reverseStart[city + 1]; ++r) {
+            int other = reverseList[r];
+            if (!inTour[other]) heap.push({insertionCost(other, after), other});
+        }
+    }
+
+    result.reserve(n);
+    int city = hull.front();
+    do {
+        result.push_back(city);
+        city = next[city];
+    } while (city != hull.front());
+    return result;
+}
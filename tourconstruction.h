@@ -0,0 +1,48 @@
+#ifndef TOURCONSTRUCTION_H
+#define TOURCONSTRUCTION_H
+
+#include <QString>
+#include <vector>
+#include "distancematrix.h"
+
+// 初始回路构造
+// 四种方法都只依赖空间网格和 k 近邻表, 不需要 n*n 的距离矩阵, 复杂度接近 O(n log n):
+// 最近邻(空间网格找最近的未访问城市)、贪心边(按长度从短到长连 k 近邻边, 最后把片段首尾相接)、
+// 空间填充曲线(按 Hilbert 曲线上的位置排序)、凸包最廉价插入(从凸包出发, 每次插入代价最小的城市)
+class TourConstruction {
+public:
+    enum Method {
+        NearestNeighbor,
+        GreedyEdge,
+        SpaceFillingCurve,
+        ConvexHullInsertion
+    };
+
+    // 坐标需在对象使用期间保持有效
+    explicit TourConstruction(const CityCoordinates &coords, int neighborCount = 10);
+
+    // 按指定方法构造回路; start 只对最近邻法有效
+    std::vector<int> build(Method method, int start = 0) const;
+
+    std::vector<int> nearestNeighbor(int start = 0) const;
+    std::vector<int> greedyEdge() const;
+    std::vector<int> spaceFillingCurve() const;
+    std::vector<int> convexHullInsertion() const;
+
+    // 界面和日志中显示的名称
+    static QString methodName(Method method);
+
+private:
+    const CityCoordinates &coords;
+    int n;
+    int k;
+    std::vector<int> neighborList; // n * k 个近邻, 按距离从近到远
+
+    double dist(int a, int b) const { return coords.distance(a, b); }
+    const int *neighbors(int city) const { return &neighborList[static_cast<size_t>(city) * k]; }
+
+    // 凸包顶点, 逆时针
+    std::vector<int> convexHull() const;
+};
+
+#endif // TOURCONSTRUCTION_H
@@ -0,0 +1,108 @@
+#include "tourlayeritem.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <cmath>
+
+namespace {
+
+const int ANTIALIAS_LIMIT = 20000;   // 回路边数不超过这个数时启用抗锯齿
+const double TOUR_TOLERANCE = 2;     // 回路中连续短于这个像素数的边合并成一条
+const int TOUR_CHUNK = 256;          // 回路按这么多条边分块做外接矩形
+
+// 两个矩形是否相交, 宽或高为 0 的矩形(水平、竖直的边)也算
+bool overlaps(const QRectF &a, const QRectF &b) {
+    return a.right() >= b.left() && a.left() <= b.right() && a.bottom() >= b.top() && a.top() <= b.bottom();
+}
+
+} // namespace
+
+TourLayerItem::TourLayerItem(QGraphicsItem *parent) : QGraphicsItem(parent) {
+    // 需要 exposedRect 来裁剪到视口
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+// 设置回路, 重算分块外接矩形; 范围不变时只触发本层重绘
+void TourLayerItem::setTour(const QPolygonF &tour) {
+    this->tour = tour;
+
+    // 第 k 块包含第 k * TOUR_CHUNK 到第 (k + 1) * TOUR_CHUNK 个点之间的边, 最后一块含连回起点的边
+    int n = tour.size();
+    tourChunks.clear();
+    QRectF area;
+    for (int begin = 0; begin < n; begin += TOUR_CHUNK) {
+        int end = qMin(begin + TOUR_CHUNK, n);
+        double minX = tour[begin].x(), maxX = minX;
+        double minY = tour[begin].y(), maxY = minY;
+        for (int i = begin + 1; i <= end; ++i) {
+            const QPointF &point = tour[i % n];
+            minX = qMin(minX, point.x());
+            maxX = qMax(maxX, point.x());
+            minY = qMin(minY, point.y());
+            maxY = qMax(maxY, point.y());
+        }
+        tourChunks.push_back(QRectF(minX, minY, maxX - minX, maxY - minY));
+        area |= tourChunks.back();
+    }
+
+    // 四周留出余量给画笔宽度; 城市不变时实时回路的范围也不变, 不需要通知场景几何变化
+    if (!area.isNull()) {
+        double margin = qMax(qMax(area.width(), area.height()) * 0.1, 1.0);
+        area.adjust(-margin, -margin, margin, margin);
+    }
+    if (area != bounds) {
+        prepareGeometryChange();
+        bounds = area;
+    }
+    update();
+}
+
+// 回路: 裁剪到视口, 连续的短于 TOUR_TOLERANCE 个像素的边合并成一条, 偏差不超过这个像素数
+void TourLayerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    Q_UNUSED(widget);
+
+    int n = tour.size();
+    if (n < 2) return;
+
+    // 每单位场景长度对应的像素数
+    double pixelsPerUnit = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    if (pixelsPerUnit <= 0) return;
+
+    double minStep = TOUR_TOLERANCE / pixelsPerUnit;
+    QRectF area = option->exposedRect.adjusted(-minStep, -minStep, minStep, minStep);
+
+    lines.clear();
+    QPointF last = tour.first();
+    for (int chunk = 0; chunk < static_cast<int>(tourChunks.size()); ++chunk) {
+        int begin = chunk * TOUR_CHUNK;
+        int end = qMin(begin + TOUR_CHUNK, n);
+
+        // 整块在视口外: 直接跳到块尾
+        if (!overlaps(tourChunks[chunk], area)) {
+            last = tour[end % n];
+            continue;
+        }
+
+        for (int i = begin + 1; i <= end; ++i) {
+            const QPointF &point = tour[i % n];
+            // 终点连回起点的边总是保留, 路径保持闭合
+            if (i < n && std::fabs(point.x() - last.x()) < minStep && std::fabs(point.y() - last.y()) < minStep) continue;
+
+            // 边的外接矩形与视口不相交时整条边都看不见
+            if (overlaps(QRectF(qMin(last.x(), point.x()), qMin(last.y(), point.y()),
+                                std::fabs(point.x() - last.x()), std::fabs(point.y() - last.y())), area)) {
+                lines.append(QLineF(last, point));
+            }
+            last = point;
+        }
+    }
+    if (lines.isEmpty()) return;
+
+    QPen pen(Qt::blue);
+    pen.setWidth(2);
+    pen.setCosmetic(true);
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, lines.size() <= ANTIALIAS_LIMIT);
+    painter->setPen(pen);
+    painter->drawLines(lines.constData(), static_cast<int>(lines.size()));
+    painter->restore();
+}
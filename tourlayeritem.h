@@ -0,0 +1,31 @@
+#ifndef TOURLAYERITEM_H
+#define TOURLAYERITEM_H
+
+#include <QGraphicsItem>
+#include <QLineF>
+#include <QPolygonF>
+#include <vector>
+
+// 地图的路径层, 用一个图形项成批绘制回路
+// 与城市层分开: 设置回路或刷新实时回路时只重绘这一层, 城市层从缓存中直接贴图.
+// 每次绘制只处理与视口相交的部分, 跳过整块在视口外的边, 连续短于几个像素的边合并成一条
+class TourLayerItem : public QGraphicsItem {
+public:
+    explicit TourLayerItem(QGraphicsItem *parent = nullptr);
+
+    // 设置回路经过的城市的场景坐标, 终点自动连回起点; 空表示不画回路
+    void setTour(const QPolygonF &tour);
+
+    QRectF boundingRect() const override { return bounds; }
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    QPolygonF tour;
+    std::vector<QRectF> tourChunks; // 回路每 TOUR_CHUNK 条边的外接矩形, 整块在视口外时跳过
+    QRectF bounds;
+
+    // 绘制时复用的缓冲区
+    QList<QLineF> lines;
+};
+
+#endif // TOURLAYERITEM_H
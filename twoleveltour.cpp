@@ -0,0 +1,195 @@
+#include "twoleveltour.h"
+#include <algorithm>
+#include <cmath>
+
+void TwoLevelTour::init(const std::vector<int> &order) {
+    n = static_cast<int>(order.size());
+    groupSize = std::max(8, static_cast<int>(std::sqrt(static_cast<double>(n))));
+    segmentOf.assign(n, 0);
+    indexOf.assign(n, 0);
+    segments.clear();
+    ring.clear();
+    freeSegments.clear();
+
+    for (int start = 0; start < n; start += groupSize) {
+        Segment segment;
+        segment.rank = static_cast<int>(ring.size());
+        int end = std::min(n, start + groupSize);
+        for (int i = start; i < end; ++i) {
+            segmentOf[order[i]] = static_cast<int>(segments.size());
+            indexOf[order[i]] = i - start;
+            segment.cities.push_back(order[i]);
+        }
+        ring.push_back(static_cast<int>(segments.size()));
+        segments.push_back(std::move(segment));
+    }
+}
+
+std::vector<int> TwoLevelTour::order() const {
+    std::vector<int> result;
+    result.reserve(n);
+    for (int seg : ring) {
+        const Segment &s = segments[seg];
+        if (s.reversed) {
+            result.insert(result.end(), s.cities.rbegin(), s.cities.rend());
+        } else {
+            result.insert(result.end(), s.cities.begin(), s.cities.end());
+        }
+    }
+    return result;
+}
+
+void TwoLevelTour::reverseInside(int seg, int from, int to) {
+    Segment &s = segments[seg];
+    int m = static_cast<int>(s.cities.size());
+    int left = s.reversed ? m - 1 - to : from;
+    int right = s.reversed ? m - 1 - from : to;
+    std::reverse(s.cities.begin() + left, s.cities.begin() + right + 1);
+    for (int i = left; i <= right; ++i) {
+        indexOf[s.cities[i]] = i;
+    }
+}
+
+void TwoLevelTour::splitBefore(int city) {
+    int seg = segmentOf[city];
+    int at = logical(city);
+    if (at == 0) return;
+
+    // 逻辑位置 at 之后的部分移到新段, 新段沿用原段的翻转标记
+    Segment tail;
+    tail.reversed = segments[seg].reversed;
+    std::vector<int> &cities = segments[seg].cities;
+    int m = static_cast<int>(cities.size());
+    if (!tail.reversed) {
+        tail.cities.assign(cities.begin() + at, cities.end());
+        cities.resize(at);
+    } else {
+        // 翻转的段中逻辑尾部位于数组开头
+        tail.cities.assign(cities.begin(), cities.begin() + (m - at));
+        cities.erase(cities.begin(), cities.begin() + (m - at));
+        for (int i = 0; i < static_cast<int>(cities.size()); ++i) {
+            indexOf[cities[i]] = i;
+        }
+    }
+
+    int tailId;
+    if (!freeSegments.empty()) {
+        tailId = freeSegments.back();
+        freeSegments.pop_back();
+    } else {
+        tailId = static_cast<int>(segments.size());
+        segments.emplace_back();
+    }
+    for (int i = 0; i < static_cast<int>(tail.cities.size()); ++i) {
+        segmentOf[tail.cities[i]] = tailId;
+        indexOf[tail.cities[i]] = i;
+    }
+    int rank = segments[seg].rank + 1;
+    segments[tailId] = std::move(tail);
+
+    // 新段插在原段之后, 其后各段的位置加一
+    ring.insert(ring.begin() + rank, tailId);
+    for (int r = rank; r < static_cast<int>(ring.size()); ++r) {
+        segments[ring[r]].rank = r;
+    }
+}
+
+void TwoLevelTour::reverseSegments(int from, int to) {
+    int count = static_cast<int>(ring.size());
+    int length = (to - from + count) % count + 1;
+    int left = from;
+    int right = to;
+    for (int k = 0; k < length / 2; ++k) {
+        std::swap(ring[left], ring[right]);
+        left = left + 1 == count ? 0 : left + 1;
+        right = right == 0 ? count - 1 : right - 1;
+    }
+    int r = from;
+    for (int k = 0; k < length; ++k) {
+        Segment &s = segments[ring[r]];
+        s.reversed = !s.reversed;
+        s.rank = r;
+        r = r + 1 == count ? 0 : r + 1;
+    }
+}
+
+void TwoLevelTour::normalize(int seg) {
+    Segment &s = segments[seg];
+    if (!s.reversed) return;
+    std::reverse(s.cities.begin(), s.cities.end());
+    for (int i = 0; i < static_cast<int>(s.cities.size()); ++i) {
+        indexOf[s.cities[i]] = i;
+    }
+    s.reversed = false;
+}
+
+void TwoLevelTour::mergeSmall(int city) {
+    int count = static_cast<int>(ring.size());
+    if (count < 2) return;
+    int seg = segmentOf[city];
+    int size = static_cast<int>(segments[seg].cities.size());
+    if (size * 2 > groupSize) return;
+
+    // 与较短的相邻段合并, 合并后不超过一段的标准长度
+    int rank = segments[seg].rank;
+    int before = ring[rank == 0 ? count - 1 : rank - 1];
+    int after = ring[rank + 1 == count ? 0 : rank + 1];
+    int other = segments[before].cities.size() <= segments[after].cities.size() ? before : after;
+    if (size + static_cast<int>(segments[other].cities.size()) > groupSize) return;
+
+    int left = other == before ? before : seg;
+    int right = other == before ? seg : after;
+    normalize(left);
+    normalize(right);
+    std::vector<int> &into = segments[left].cities;
+    for (int moved : segments[right].cities) {
+        segmentOf[moved] = left;
+        indexOf[moved] = static_cast<int>(into.size());
+        into.push_back(moved);
+    }
+    segments[right].cities.clear();
+    freeSegments.push_back(right);
+
+    int removed = segments[right].rank;
+    ring.erase(ring.begin() + removed);
+    for (int r = removed; r < static_cast<int>(ring.size()); ++r) {
+        segments[ring[r]].rank = r;
+    }
+}
+
+void TwoLevelTour::flip(int a, int b, int c, int d) {
+    // b..c 或 d..a 落在同一段内时直接在段内翻转, 不切分
+    if (segmentOf[b] == segmentOf[c] && logical(b) <= logical(c)) {
+        reverseInside(segmentOf[b], logical(b), logical(c));
+        return;
+    }
+    if (segmentOf[d] == segmentOf[a] && logical(d) <= logical(a)) {
+        reverseInside(segmentOf[d], logical(d), logical(a));
+        return;
+    }
+
+    // 切分后 b..c 与 d..a 都由整段组成, 翻转段数较少的一侧
+    splitBefore(b);
+    splitBefore(d);
+    int count = static_cast<int>(ring.size());
+    int rb = segments[segmentOf[b]].rank;
+    int rc = segments[segmentOf[c]].rank;
+    int inner = (rc - rb + count) % count + 1;
+    if (inner * 2 <= count) {
+        reverseSegments(rb, rc);
+    } else {
+        reverseSegments(segments[segmentOf[d]].rank, segments[segmentOf[a]].rank);
+    }
+
+    // 切分点两侧的小段并回相邻段
+    for (int city : {a, b, c, d}) {
+        mergeSmall(city);
+    }
+    if (static_cast<int>(ring.size()) > 2 * ((n + groupSize - 1) / groupSize)) {
+        rebuild();
+    }
+}
+
+void TwoLevelTour::rebuild() {
+    init(order());
+}
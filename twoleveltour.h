@@ -0,0 +1,105 @@
+#ifndef TWOLEVELTOUR_H
+#define TWOLEVELTOUR_H
+
+#include <vector>
+
+// 两级链表表示的回路
+// 城市按回路顺序分成约 √n 段, 每段是一个小数组并带一个翻转标记, 段本身按回路顺序排成一个环;
+// next/prev/between 为 O(1), 2-opt 翻转先在 b 和 d 处把段切开, 再把整段倒序并切换翻转标记, O(√n);
+// 切分出的小段在翻转后与相邻段合并, 段长保持在 √n 附近; 段数仍失控时按当前顺序整体重新分段
+class TwoLevelTour {
+public:
+    void init(const std::vector<int> &order);
+
+    int size() const { return n; }
+
+    int next(int city) const {
+        const Segment &s = segments[segmentOf[city]];
+        int i = indexOf[city];
+        if (!s.reversed) {
+            if (i + 1 < static_cast<int>(s.cities.size())) return s.cities[i + 1];
+        } else if (i > 0) {
+            return s.cities[i - 1];
+        }
+        return first(ring[s.rank + 1 == static_cast<int>(ring.size()) ? 0 : s.rank + 1]);
+    }
+
+    int prev(int city) const {
+        const Segment &s = segments[segmentOf[city]];
+        int i = indexOf[city];
+        if (!s.reversed) {
+            if (i > 0) return s.cities[i - 1];
+        } else if (i + 1 < static_cast<int>(s.cities.size())) {
+            return s.cities[i + 1];
+        }
+        return last(ring[s.rank == 0 ? static_cast<int>(ring.size()) - 1 : s.rank - 1]);
+    }
+
+    // 从 a 沿回路方向走到 c 的途中(含两端)是否经过 b
+    bool between(int a, int b, int c) const {
+        long long ka = key(a), kb = key(b), kc = key(c);
+        if (ka <= kc) return ka <= kb && kb <= kc;
+        return kb >= ka || kb <= kc;
+    }
+
+    // 2-opt: 要求 next(a) == b, next(c) == d; 删除边 (a,b), (c,d), 加入 (a,c), (b,d)
+    void flip(int a, int b, int c, int d);
+
+    // 从任意城市开始的城市序列
+    std::vector<int> order() const;
+
+private:
+    struct Segment {
+        std::vector<int> cities;
+        bool reversed = false;
+        int rank = 0; // 在段环中的位置
+    };
+
+    int n = 0;
+    int groupSize = 1;              // 重新分段时每段的城市数
+    std::vector<Segment> segments;
+    std::vector<int> ring;          // 段环: 位置 -> 段编号
+    std::vector<int> segmentOf;     // 城市 -> 段编号
+    std::vector<int> indexOf;       // 城市 -> 段内数组下标
+    std::vector<int> freeSegments;  // 合并后空出的段编号, 切分时复用
+
+    int first(int seg) const {
+        const Segment &s = segments[seg];
+        return s.reversed ? s.cities.back() : s.cities.front();
+    }
+    int last(int seg) const {
+        const Segment &s = segments[seg];
+        return s.reversed ? s.cities.front() : s.cities.back();
+    }
+
+    // 城市在段内的逻辑位置(按回路方向)
+    int logical(int city) const {
+        const Segment &s = segments[segmentOf[city]];
+        return s.reversed ? static_cast<int>(s.cities.size()) - 1 - indexOf[city] : indexOf[city];
+    }
+
+    // 可比较的全局顺序键
+    long long key(int city) const {
+        return static_cast<long long>(segments[segmentOf[city]].rank) * (n + 1) + logical(city);
+    }
+
+    // 在段内翻转逻辑位置 from..to 之间的城市
+    void reverseInside(int seg, int from, int to);
+
+    // 把 city 之前的部分切成单独一段, 使 city 成为所在段的第一个城市
+    void splitBefore(int city);
+
+    // 翻转段环中 from..to(环形)之间的整段
+    void reverseSegments(int from, int to);
+
+    // 把数组顺序调整为逻辑顺序, 清除翻转标记
+    void normalize(int seg);
+
+    // 所在段过小时与相邻段合并
+    void mergeSmall(int city);
+
+    // 按当前顺序重新均匀分段
+    void rebuild();
+};
+
+#endif // TWOLEVELTOUR_H